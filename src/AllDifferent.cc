@@ -0,0 +1,237 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include "AllDifferent.h"
+
+using namespace crucio;
+using namespace std;
+
+const uint32_t AllDifferent::NONE;
+
+AllDifferent::AllDifferent() :
+    m_domains(),
+    m_edges(),
+    m_values(),
+    m_slotMatch(),
+    m_valueMatch(),
+    m_visited(),
+    m_visitMark(0),
+    m_escaping(),
+    m_component(),
+    m_lowLink(),
+    m_tarjanIndex(),
+    m_tarjanStack(),
+    m_onStack(),
+    m_tarjanCounter(0),
+    m_components(0),
+    m_removals(),
+    m_hallValues()
+{
+}
+
+void AllDifferent::clear()
+{
+    m_domains.clear();
+    m_removals.clear();
+    m_hallValues.clear();
+}
+
+bool AllDifferent::propagate()
+{
+    const uint32_t slots = (uint32_t)m_domains.size();
+    uint32_t si, vi;
+
+    m_removals.assign(slots, vector<uint32_t>());
+    m_hallValues.clear();
+
+    // local value indexes
+    m_values.clear();
+    for (si = 0; si < slots; ++si) {
+        m_values.insert(m_values.end(), m_domains[si].begin(),
+                        m_domains[si].end());
+    }
+    sort(m_values.begin(), m_values.end());
+    m_values.erase(unique(m_values.begin(), m_values.end()), m_values.end());
+    const uint32_t values = (uint32_t)m_values.size();
+
+    // more slots than values, pigeonhole
+    if (slots > values) {
+        return false;
+    }
+
+    m_edges.resize(slots);
+    for (si = 0; si < slots; ++si) {
+        const vector<uint32_t>& dom = m_domains[si];
+        vector<uint32_t>& edges = m_edges[si];
+
+        edges.clear();
+        vector<uint32_t>::const_iterator idIt;
+        for (idIt = dom.begin(); idIt != dom.end(); ++idIt) {
+            edges.push_back((uint32_t)(lower_bound(m_values.begin(),
+                                                   m_values.end(), *idIt) - m_values.begin()));
+        }
+    }
+
+    // maximum matching by augmenting paths, every slot must be matched
+    m_slotMatch.assign(slots, NONE);
+    m_valueMatch.assign(values, NONE);
+    m_visited.assign(values, 0);
+    m_visitMark = 0;
+    for (si = 0; si < slots; ++si) {
+        ++m_visitMark;
+        if (!augment(si)) {
+            return false;
+        }
+    }
+
+    // slots whose value may be released along an alternating path to a
+    // free value
+    markEscaping();
+
+    // components of the others, slot -> slot through matched values
+    m_component.assign(slots, NONE);
+    m_lowLink.assign(slots, 0);
+    m_tarjanIndex.assign(slots, NONE);
+    m_onStack.assign(slots, false);
+    m_tarjanStack.clear();
+    m_tarjanCounter = 0;
+    m_components = 0;
+    for (si = 0; si < slots; ++si) {
+        if (!m_escaping[si] && (m_tarjanIndex[si] == NONE)) {
+            connect(si);
+        }
+    }
+
+    // values matched to non-escaping slots are held by Hall sets, the
+    // edges reaching them across components belong to no matching
+    for (si = 0; si < slots; ++si) {
+        const vector<uint32_t>& edges = m_edges[si];
+        vector<uint32_t>::const_iterator vIt;
+        for (vIt = edges.begin(); vIt != edges.end(); ++vIt) {
+            vi = *vIt;
+
+            const uint32_t mSi = m_valueMatch[vi];
+            if ((mSi == NONE) || (mSi == si) || m_escaping[mSi]) {
+                continue;
+            }
+            if (m_escaping[si] || (m_component[si] != m_component[mSi])) {
+                m_removals[si].push_back(m_values[vi]);
+            }
+        }
+        if (!m_escaping[si]) {
+            m_hallValues.push_back(m_values[m_slotMatch[si]]);
+        }
+    }
+    sort(m_hallValues.begin(), m_hallValues.end());
+
+    return true;
+}
+
+bool AllDifferent::augment(const uint32_t si)
+{
+    const vector<uint32_t>& edges = m_edges[si];
+    vector<uint32_t>::const_iterator vIt;
+
+    // free value first
+    for (vIt = edges.begin(); vIt != edges.end(); ++vIt) {
+        if (m_valueMatch[*vIt] == NONE) {
+            m_slotMatch[si] = *vIt;
+            m_valueMatch[*vIt] = si;
+            return true;
+        }
+    }
+
+    // otherwise moves the current owner
+    for (vIt = edges.begin(); vIt != edges.end(); ++vIt) {
+        const uint32_t vi = *vIt;
+        if (m_visited[vi] == m_visitMark) {
+            continue;
+        }
+        m_visited[vi] = m_visitMark;
+
+        if (augment(m_valueMatch[vi])) {
+            m_slotMatch[si] = vi;
+            m_valueMatch[vi] = si;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AllDifferent::markEscaping()
+{
+    const uint32_t slots = (uint32_t)m_domains.size();
+    const uint32_t values = (uint32_t)m_values.size();
+    uint32_t si, vi;
+
+    // (value -> slots containing it) table
+    vector<vector<uint32_t> > owners(values);
+    for (si = 0; si < slots; ++si) {
+        const vector<uint32_t>& edges = m_edges[si];
+        vector<uint32_t>::const_iterator vIt;
+        for (vIt = edges.begin(); vIt != edges.end(); ++vIt) {
+            owners[*vIt].push_back(si);
+        }
+    }
+
+    // visits backwards from free values
+    m_escaping.assign(slots, false);
+    vector<uint32_t> queue;
+    for (vi = 0; vi < values; ++vi) {
+        if (m_valueMatch[vi] == NONE) {
+            queue.push_back(vi);
+        }
+    }
+    while (!queue.empty()) {
+        vi = queue.back();
+        queue.pop_back();
+
+        // slots taking vi release their own matched value
+        vector<uint32_t>::const_iterator sIt;
+        for (sIt = owners[vi].begin(); sIt != owners[vi].end(); ++sIt) {
+            if (!m_escaping[*sIt]) {
+                m_escaping[*sIt] = true;
+                queue.push_back(m_slotMatch[*sIt]);
+            }
+        }
+    }
+}
+
+void AllDifferent::connect(const uint32_t si)
+{
+    m_tarjanIndex[si] = m_tarjanCounter;
+    m_lowLink[si] = m_tarjanCounter;
+    ++m_tarjanCounter;
+    m_tarjanStack.push_back(si);
+    m_onStack[si] = true;
+
+    // si -> owner of every other value si may take
+    const vector<uint32_t>& edges = m_edges[si];
+    vector<uint32_t>::const_iterator vIt;
+    for (vIt = edges.begin(); vIt != edges.end(); ++vIt) {
+        const uint32_t tSi = m_valueMatch[*vIt];
+        if ((tSi == NONE) || (tSi == si) || m_escaping[tSi]) {
+            continue;
+        }
+        if (m_tarjanIndex[tSi] == NONE) {
+            connect(tSi);
+            m_lowLink[si] = min(m_lowLink[si], m_lowLink[tSi]);
+        } else if (m_onStack[tSi]) {
+            m_lowLink[si] = min(m_lowLink[si], m_tarjanIndex[tSi]);
+        }
+    }
+
+    // component root
+    if (m_lowLink[si] == m_tarjanIndex[si]) {
+        uint32_t cSi;
+        do {
+            cSi = m_tarjanStack.back();
+            m_tarjanStack.pop_back();
+            m_onStack[cSi] = false;
+            m_component[cSi] = m_components;
+        } while (cSi != si);
+        ++m_components;
+    }
+}
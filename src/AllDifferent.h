@@ -0,0 +1,84 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __ALL_DIFFERENT_H
+#define __ALL_DIFFERENT_H
+
+#include <algorithm>
+#include <vector>
+
+#include "common.h"
+
+namespace crucio
+{
+    // alldifferent propagator over the slots of a same length group,
+    // matching-based (Regin): slots must take pairwise distinct IDs
+    class AllDifferent
+    {
+    public:
+        AllDifferent();
+
+        // starts a new propagation
+        void clear();
+
+        // adds a slot with its (sorted, unique) candidate IDs
+        template<typename It>
+        void addSlot(It begin, It end) {
+            m_domains.push_back(std::vector<uint32_t>(begin, end));
+        }
+        uint32_t getSlots() const {
+            return (uint32_t)m_domains.size();
+        }
+
+        // false if slots can't take pairwise distinct IDs
+        bool propagate();
+
+        // IDs no maximum matching assigns to i-th slot (after propagate)
+        const std::vector<uint32_t>& getRemovals(const uint32_t i) const {
+            return m_removals[i];
+        }
+
+        // IDs held by Hall sets, unavailable to any slot not added (sorted)
+        const std::vector<uint32_t>& getHallValues() const {
+            return m_hallValues;
+        }
+
+    private:
+        static const uint32_t NONE = 0xFFFFFFFF;
+
+        // slots domains (IDs) and their local value indexes
+        std::vector<std::vector<uint32_t> > m_domains;
+        std::vector<std::vector<uint32_t> > m_edges;
+        std::vector<uint32_t> m_values;
+
+        // maximum matching
+        std::vector<uint32_t> m_slotMatch;
+        std::vector<uint32_t> m_valueMatch;
+        std::vector<uint32_t> m_visited;
+        uint32_t m_visitMark;
+
+        // slots able to swap their value for a free one
+        std::vector<bool> m_escaping;
+
+        // strongly connected components (Tarjan)
+        std::vector<uint32_t> m_component;
+        std::vector<uint32_t> m_lowLink;
+        std::vector<uint32_t> m_tarjanIndex;
+        std::vector<uint32_t> m_tarjanStack;
+        std::vector<bool> m_onStack;
+        uint32_t m_tarjanCounter;
+        uint32_t m_components;
+
+        // results
+        std::vector<std::vector<uint32_t> > m_removals;
+        std::vector<uint32_t> m_hallValues;
+
+        bool augment(const uint32_t si);
+        void markEscaping();
+        void connect(const uint32_t si);
+    };
+}
+
+#endif
@@ -0,0 +1,39 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include "Arena.h"
+
+using namespace crucio;
+using namespace std;
+
+const uint32_t Arena::DEFAULT_CHUNK_SIZE;
+const uint32_t Arena::ALIGNMENT;
+
+Arena::Arena(const uint32_t chunkSize) :
+    m_chunkSize(chunkSize),
+    m_chunks(),
+    m_cursor(NULL),
+    m_left(0),
+    m_bytes(0)
+{
+}
+
+Arena::~Arena()
+{
+    vector<char*>::iterator cIt;
+    for (cIt = m_chunks.begin(); cIt != m_chunks.end(); ++cIt) {
+        delete[] *cIt;
+    }
+}
+
+// new chunk, oversized requests get one of their own
+void Arena::grow(const uint32_t size)
+{
+    const uint32_t chunkSize = max(size, m_chunkSize);
+
+    m_cursor = new char[chunkSize];
+    m_left = chunkSize;
+    m_chunks.push_back(m_cursor);
+}
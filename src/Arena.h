@@ -0,0 +1,59 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <vector>
+
+#include "common.h"
+
+namespace crucio
+{
+    // monotonic buffer: bump allocations from large chunks, all freed
+    // at once on destruction; objects placed here (placement new) must
+    // be destroyed explicitly if they own other resources
+    class Arena
+    {
+    public:
+        static const uint32_t DEFAULT_CHUNK_SIZE = 64 << 10;
+        static const uint32_t ALIGNMENT = 16;
+
+        explicit Arena(const uint32_t chunkSize = DEFAULT_CHUNK_SIZE);
+        ~Arena();
+
+        // uninitialized, aligned memory
+        void* allocate(const uint32_t bytes) {
+            const uint32_t size = (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+            if (size > m_left) {
+                grow(size);
+            }
+            void* const p = m_cursor;
+            m_cursor += size;
+            m_left -= size;
+            m_bytes += size;
+            return p;
+        }
+
+        // statistics
+        uint32_t getBytes() const {
+            return m_bytes;
+        }
+        uint32_t getChunksNum() const {
+            return (uint32_t)m_chunks.size();
+        }
+
+    private:
+        const uint32_t m_chunkSize;
+        std::vector<char*> m_chunks;
+        char* m_cursor;
+        uint32_t m_left;
+        uint32_t m_bytes;
+
+        void grow(const uint32_t size);
+    };
+}
+
+#endif
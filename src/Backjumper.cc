@@ -28,6 +28,25 @@ void Backjumper::configure(const vector<uint32_t>& order,
     m_deps = deps;
 }
 
+// i = variables count
+void Backjumper::solution(const uint32_t i)
+{
+    m_origin = i;
+
+    // all variables before i are candidate jumps
+    m_jumps.clear();
+    for (uint32_t ji = 0; ji < i; ++ji) {
+        m_jumps.insert(ji);
+    }
+
+    // first one is i - 1
+    m_exhausted = m_jumps.empty();
+    if (!m_exhausted) {
+        m_destination = *m_jumps.begin();
+        m_jumps.erase(m_jumps.begin());
+    }
+}
+
 // i = variable, failed = further failed variables
 void Backjumper::jump(const uint32_t i, const set<uint32_t>* const failed)
 {
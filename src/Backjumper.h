@@ -35,6 +35,10 @@ namespace crucio
             return m_destination;
         }
 
+        // a solution found at i conflicts with every previous variable,
+        // so that search resumes chronologically
+        void solution(const uint32_t i);
+
         // clears jumps set
         void reset() {
             m_jumps.clear();
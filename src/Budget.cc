@@ -0,0 +1,56 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include <ctime>
+
+#include "Budget.h"
+
+using namespace crucio;
+using namespace std;
+
+const uint32_t Budget::CHECK_INTERVAL;
+
+Budget::Budget() :
+    m_deadlineMillis(0),
+    m_nodeLimit(0),
+    m_backtrackLimit(0),
+    m_cancelFlag(NULL),
+    m_startMillis(0),
+    m_nodes(0),
+    m_backtracks(0),
+    m_countdown(CHECK_INTERVAL),
+    m_reason(NONE)
+{
+}
+
+void Budget::start()
+{
+    m_startMillis = nowMillis();
+    m_nodes = 0;
+    m_backtracks = 0;
+    m_countdown = CHECK_INTERVAL;
+    m_reason = NONE;
+}
+
+uint64_t Budget::getElapsedMillis() const
+{
+    return (nowMillis() - m_startMillis);
+}
+
+uint64_t Budget::nowMillis()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000 + (uint64_t) ts.tv_nsec / 1000000);
+}
+
+void Budget::check()
+{
+    if (m_cancelFlag && *m_cancelFlag) {
+        exhaust(CANCELLED);
+    } else if ((m_deadlineMillis > 0) && (getElapsedMillis() >= m_deadlineMillis)) {
+        exhaust(DEADLINE);
+    }
+}
@@ -0,0 +1,125 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __BUDGET_H
+#define __BUDGET_H
+
+#include <csignal>
+
+#include "common.h"
+
+namespace crucio
+{
+    // search limits: millisecond deadline on a monotonic clock, nodes
+    // and backtracks counts, external cancellation; the clock and the
+    // cancel flag are only read every CHECK_INTERVAL nodes
+    class Budget
+    {
+    public:
+        enum Reason {
+            NONE,
+            DEADLINE,
+            NODES,
+            BACKTRACKS,
+            CANCELLED
+        };
+
+        static const uint32_t CHECK_INTERVAL = 256;
+
+        Budget();
+
+        // 0 = unlimited
+        void setDeadlineMillis(const uint32_t millis) {
+            m_deadlineMillis = millis;
+        }
+        uint32_t getDeadlineMillis() const {
+            return m_deadlineMillis;
+        }
+        void setNodeLimit(const uint32_t nodes) {
+            m_nodeLimit = nodes;
+        }
+        uint32_t getNodeLimit() const {
+            return m_nodeLimit;
+        }
+        void setBacktrackLimit(const uint32_t backtracks) {
+            m_backtrackLimit = backtracks;
+        }
+        uint32_t getBacktrackLimit() const {
+            return m_backtrackLimit;
+        }
+
+        // external flag, polled along with the clock (e.g. set from a
+        // signal handler or another thread)
+        void setCancelFlag(volatile const sig_atomic_t* const flag) {
+            m_cancelFlag = flag;
+        }
+
+        // restarts clock and counters
+        void start();
+
+        // counts a search node, true once the budget is exhausted
+        bool onNode() {
+            ++m_nodes;
+            if ((m_nodeLimit > 0) && (m_nodes > m_nodeLimit)) {
+                exhaust(NODES);
+            } else if (--m_countdown == 0) {
+                m_countdown = CHECK_INTERVAL;
+                check();
+            }
+            return (m_reason != NONE);
+        }
+
+        // counts a backtrack, true once the budget is exhausted
+        bool onBacktrack() {
+            ++m_backtracks;
+            if ((m_backtrackLimit > 0) && (m_backtracks > m_backtrackLimit)) {
+                exhaust(BACKTRACKS);
+            }
+            return (m_reason != NONE);
+        }
+
+        // forces a check regardless of interval
+        bool isExhausted() {
+            check();
+            return (m_reason != NONE);
+        }
+        Reason getReason() const {
+            return m_reason;
+        }
+
+        // statistics
+        uint32_t getNodes() const {
+            return m_nodes;
+        }
+        uint32_t getBacktracks() const {
+            return m_backtracks;
+        }
+        uint64_t getElapsedMillis() const;
+
+        // monotonic clock
+        static uint64_t nowMillis();
+
+    private:
+        uint32_t m_deadlineMillis;
+        uint32_t m_nodeLimit;
+        uint32_t m_backtrackLimit;
+        volatile const sig_atomic_t* m_cancelFlag;
+
+        uint64_t m_startMillis;
+        uint32_t m_nodes;
+        uint32_t m_backtracks;
+        uint32_t m_countdown;
+        Reason m_reason;
+
+        void check();
+        void exhaust(const Reason reason) {
+            if (m_reason == NONE) {
+                m_reason = reason;
+            }
+        }
+    };
+}
+
+#endif
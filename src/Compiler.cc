@@ -3,6 +3,8 @@
 // License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
 //
 
+#include <algorithm>
+
 #include "Compiler.h"
 #include "LanguageMatcher.h"
 
@@ -12,7 +14,20 @@ using namespace std;
 Compiler::Compiler() :
     m_unique(false),
     m_deterministic(false),
-    m_model(NULL)
+    m_budget(),
+    m_sink(NULL),
+    m_solutionLimit(0),
+    m_minDistance(0),
+    m_solutionsNum(0),
+    m_solutions(),
+    m_letters(),
+    m_componentStarts(),
+    m_componentFailed(false),
+    m_bestDepth(0),
+    m_bestLetters(),
+    m_partial(false),
+    m_model(NULL),
+    m_random()
 {
 }
 
@@ -24,8 +39,15 @@ Compiler::Result Compiler::compile(Model* const model, const Walk& walk)
 {
     assert(model != NULL);
     
-    // timeout reference
-    m_compileSeconds = time(NULL);
+    // budget reference
+    m_budget.start();
+
+    // no solutions and partial fill yet
+    m_solutionsNum = 0;
+    m_solutions.clear();
+    m_bestDepth = 0;
+    m_bestLetters.clear();
+    m_partial = false;
 
     // model reference
     m_model = model;
@@ -43,12 +65,16 @@ Compiler::Result Compiler::compile(Model* const model, const Walk& walk)
 
     // prior check for non-determinism
     if (isDeterministic()) {
-        const map<uint32_t, set<uint32_t> >& wordsByLength =
+        const PackedArray<uint32_t>& wordsByLength =
             m_model->getWordsByLength();
 
         // no length mapping to one-and-only-one word
-        if (find_if(wordsByLength.begin(), wordsByLength.end(),
-                    IsSimpleDomain()) == wordsByLength.end()) {
+        uint32_t len = 0;
+        while ((len < wordsByLength.getRowsNum()) &&
+                (wordsByLength[len].size() != 1)) {
+            ++len;
+        }
+        if (len == wordsByLength.getRowsNum()) {
             return FAILURE_ND_GRID;
         }
     }
@@ -60,6 +86,7 @@ Compiler::Result Compiler::compile(Model* const model, const Walk& walk)
 
         // resets internal status
         reset();
+        m_componentFailed = false;
 
         // defaults to valid solution (helps debugging, avoids
         // infinite loop)
@@ -67,8 +94,17 @@ Compiler::Result Compiler::compile(Model* const model, const Walk& walk)
 
         // starts backtracking from variable 0
         const Result result = compileFrom(0);
+
+        // enumeration succeeds with any solution found
+        if (m_sink != NULL) {
+            if ((result == FAILURE_IMPOSSIBLE) && (m_solutionsNum > 0)) {
+                return SUCCESS;
+            }
+            return interrupt(result);
+        }
+
         if (result != SUCCESS) {
-            return result;
+            return interrupt(result);
         }
 
         // posterior check for non-determinism
@@ -84,6 +120,11 @@ Compiler::Result Compiler::compile(Model* const model, const Walk& walk)
                 *crucio_vout << "algorithm will now restart" << endl;
             }
             *crucio_vout << endl;
+
+            // restarts are charged too
+            if (!validSolution && m_budget.isExhausted()) {
+                return interrupt(getInterruption());
+            }
         }
     } while (!validSolution);
 
@@ -91,6 +132,298 @@ Compiler::Result Compiler::compile(Model* const model, const Walk& walk)
     return SUCCESS;
 }
 
+// wi has just been completed; a deterministic solver can't tell it apart
+// from another completed word of the same length agreeing on all letters
+// crossed by either slot, since neither pattern ever excludes the other
+// word and so neither slot is ever left with a single choice
+bool Compiler::isDistinguishable(const uint32_t wi) const
+{
+    const Word* const w = m_model->getWord(wi);
+    const string& wValue = w->get();
+
+    const PackedRange<uint32_t> slWords = m_model->getWordsByLength(w->getLength());
+    PackedRange<uint32_t>::const_iterator slwIt;
+    for (slwIt = slWords.begin(); slwIt != slWords.end(); ++slwIt) {
+        const uint32_t slWi = *slwIt;
+        const Word* const slw = m_model->getWord(slWi);
+
+        // skips current and incomplete words
+        if ((slWi == wi) || !slw->isComplete()) {
+            continue;
+        }
+
+        // repeated words are left to uniqueness
+        const string& slwValue = slw->get();
+        if (slwValue == wValue) {
+            continue;
+        }
+
+        if (agreeOnCrossings(wValue, slwValue, m_model->getWordNeighbours(wi)) &&
+                agreeOnCrossings(wValue, slwValue, m_model->getWordNeighbours(slWi))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// true if v1 and v2 share the letters crossed by neighbours
+bool Compiler::agreeOnCrossings(const string& v1, const string& v2,
+                                const PackedRange<pair<uint32_t, WordCrossing> > neighbours)
+{
+    PackedRange<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
+    for (nbIt = neighbours.begin(); nbIt != neighbours.end(); ++nbIt) {
+        const uint32_t pos = nbIt->second.getPosition();
+        if (v1[pos] != v2[pos]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// a letter scores as its best matching in the worst of the (scored)
+// words crossing li, matchings left out by other letter domains being
+// skipped; once every domain letter has been seen, a word scan skips
+// the remaining loaded words (added ones may still score higher)
+ABMask Compiler::getPreferredLetters(const uint32_t li,
+                                     const ABMask domain) const
+{
+    const Dictionary* const d = m_model->getDictionary();
+    uint32_t letterScores[MAX_ALPHABET_COUNT];
+    bool scored = false;
+
+    const PackedRange<LetterPosition> letterWords = m_model->getLetterWords(li);
+    PackedRange<LetterPosition>::const_iterator lpIt;
+    for (lpIt = letterWords.begin(); lpIt != letterWords.end(); ++lpIt) {
+        const Word* const w = m_model->getWord(lpIt->getWordIndex());
+        const uint32_t len = w->getLength();
+        const MatchingResult* const result = w->getMatchingResult();
+        if (!d->isScored(len) || !result) {
+            continue;
+        }
+
+        // open cells other than li, whose letters must still be allowed
+        // by every word crossing them
+        const uint32_t pos = lpIt->getPosition();
+        const PackedRange<uint32_t> wordLetters = m_model->getWordLetters(lpIt->getWordIndex());
+        vector<pair<uint32_t, ABMask> > cells;
+        for (uint32_t cellPos = 0; cellPos < len; ++cellPos) {
+            if ((cellPos == pos) || (w->getAt(cellPos) != ANY_CHAR)) {
+                continue;
+            }
+            cells.push_back(make_pair(cellPos, getLetterDomain(wordLetters[cellPos])));
+        }
+
+        // best matching score per letter at this position (added words
+        // follow loaded ones, hence the max)
+        uint32_t wordScores[MAX_ALPHABET_COUNT];
+        ABMask seen;
+        const uint32_t baseSize = d->getBaseSize(len);
+        const vector<uint32_t>& ids = result->getIDs();
+        vector<uint32_t>::const_iterator idIt;
+        for (idIt = ids.begin(); idIt != ids.end(); ++idIt) {
+            if ((seen == domain) && (*idIt < baseSize)) {
+                idIt = lower_bound(idIt, ids.end(), baseSize);
+                if (idIt == ids.end()) {
+                    break;
+                }
+            }
+            const uint32_t vi = d->getLetterIndex(len, *idIt, pos);
+            if (!domain.test(vi) || !fitsCells(len, *idIt, cells)) {
+                continue;
+            }
+            const uint32_t score = d->getScore(len, *idIt);
+            if (!seen.test(vi)) {
+                seen.set(vi);
+                wordScores[vi] = score;
+            } else if (score > wordScores[vi]) {
+                wordScores[vi] = score;
+            }
+        }
+
+        // letters are as good as their worst crossing
+        for (uint32_t vi = 0; vi < MAX_ALPHABET_COUNT; ++vi) {
+            if (!domain.test(vi)) {
+                continue;
+            }
+            const uint32_t score = (seen.test(vi) ? wordScores[vi] : 0);
+            if (!scored || (score < letterScores[vi])) {
+                letterScores[vi] = score;
+            }
+        }
+        scored = true;
+    }
+    if (!scored) {
+        return domain;
+    }
+
+    ABMask preferred;
+    uint32_t best = 0;
+    for (uint32_t vi = 0; vi < MAX_ALPHABET_COUNT; ++vi) {
+        if (!domain.test(vi)) {
+            continue;
+        }
+        if (!preferred.any() || (letterScores[vi] > best)) {
+            preferred = ABMask();
+            best = letterScores[vi];
+        }
+        if (letterScores[vi] == best) {
+            preferred.set(vi);
+        }
+    }
+    return (preferred.any() ? preferred : domain);
+}
+
+// letters allowed by all words li belongs to
+ABMask Compiler::getLetterDomain(const uint32_t li) const
+{
+    ABMask domain = m_model->getInitLetterDomain(li);
+
+    const PackedRange<LetterPosition> letterWords = m_model->getLetterWords(li);
+    PackedRange<LetterPosition>::const_iterator lpIt;
+    for (lpIt = letterWords.begin(); lpIt != letterWords.end(); ++lpIt) {
+        const Word* const w = m_model->getWord(lpIt->getWordIndex());
+        domain &= w->getAllowed(lpIt->getPosition());
+    }
+    return domain;
+}
+
+// true if matching id has an allowed letter in every cell
+bool Compiler::fitsCells(const uint32_t len, const uint32_t id,
+                         const vector<pair<uint32_t, ABMask> >& cells) const
+{
+    const Dictionary* const d = m_model->getDictionary();
+
+    vector<pair<uint32_t, ABMask> >::const_iterator cIt;
+    for (cIt = cells.begin(); cIt != cells.end(); ++cIt) {
+        if (!cIt->second.test(d->getLetterIndex(len, id, cIt->first))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Compiler::Result Compiler::getInterruption() const
+{
+    switch (m_budget.getReason()) {
+    case Budget::DEADLINE:
+        return FAILURE_TIMEOUT;
+
+    case Budget::NODES:
+    case Budget::BACKTRACKS:
+        return FAILURE_BUDGET;
+
+    case Budget::CANCELLED:
+        return FAILURE_CANCELLED;
+
+    default:
+        return FAILURE_IMPOSSIBLE;
+    }
+}
+
+void Compiler::configureComponents(const vector<uint32_t>& order,
+                                   const vector<uint32_t>& components)
+{
+    const uint32_t varsNum = (uint32_t)order.size();
+
+    m_componentStarts.assign(varsNum, false);
+    for (uint32_t i = 0; i < varsNum; ++i) {
+        m_componentStarts[i] = ((i == 0) ||
+                                (components[order[i]] != components[order[i - 1]]));
+    }
+}
+
+bool Compiler::failComponent(const uint32_t i)
+{
+    // unique words and diversity link components together, while
+    // enumeration must still move earlier components to their next fill
+    if ((i == 0) || !m_componentStarts[i] || isUnique() ||
+            (m_minDistance > 0) || (m_sink != NULL)) {
+        return false;
+    }
+
+    *crucio_vout << "component failed at " << i << ", giving up" << endl;
+    m_componentFailed = true;
+    return true;
+}
+
+bool Compiler::acceptSolution()
+{
+    // single solution, determinism is checked by compile()
+    if (m_sink == NULL) {
+        return true;
+    }
+
+    // no restarts while enumerating, non-deterministic fills are skipped
+    if (isDeterministic() && !isDeterministicSolution()) {
+        *crucio_vout << "solution skipped (DETERMINISTIC)" << endl;
+        return false;
+    }
+
+    // diversity constraint
+    if (m_minDistance > 0) {
+        m_model->saveLetters(&m_letters);
+        if (!isDiverse(m_letters)) {
+            *crucio_vout << "solution skipped (DISTANCE)" << endl;
+            return false;
+        }
+        m_solutions.push_back(m_letters);
+    }
+
+    ++m_solutionsNum;
+    *crucio_vout << "solution " << m_solutionsNum << endl;
+
+    // streams solution, stops if refused or enough
+    const bool more = m_sink->put(*m_model, m_solutionsNum);
+    return (!more || ((m_solutionLimit > 0) &&
+                      (m_solutionsNum >= m_solutionLimit)));
+}
+
+bool Compiler::isDiverse(const vector<char>& letters) const
+{
+    const uint32_t lettersNum = (uint32_t)letters.size();
+
+    vector<vector<char> >::const_iterator sIt;
+    for (sIt = m_solutions.begin(); sIt != m_solutions.end(); ++sIt) {
+        const vector<char>& sLetters = *sIt;
+
+        // Hamming distance, stops as soon as far enough
+        uint32_t distance = 0;
+        for (uint32_t li = 0; (li < lettersNum) &&
+                (distance < m_minDistance); ++li) {
+            if (letters[li] != sLetters[li]) {
+                ++distance;
+            }
+        }
+        if (distance < m_minDistance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Compiler::Result Compiler::interrupt(const Compiler::Result result)
+{
+    switch (result) {
+    case FAILURE_TIMEOUT:
+    case FAILURE_BUDGET:
+    case FAILURE_CANCELLED:
+        // streamed solutions are better than any partial fill
+        if ((m_bestDepth > 0) && (m_solutionsNum == 0)) {
+            m_model->restoreLetters(m_bestLetters);
+            m_partial = true;
+
+            *crucio_vout << "partial fill restored (depth = " <<
+                m_bestDepth << ")" << endl;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return result;
+}
+
 // checks for solution determinism (assumes ALL words are complete, i.e.
 // model compiling succeeded)
 bool Compiler::isDeterministicSolution() const
@@ -111,16 +444,21 @@ bool Compiler::isDeterministicSolution() const
 
     // solution dictionary based on solution word list
     LanguageMatcher solMatcher(&solWordList);
-    Dictionary solDict(m_model->getAlphabet(), &solMatcher);
+    Dictionary solDict(m_model->getSymbols(), &solMatcher);
 
-    // creates new words based on solution dictionary
+    // creates new words based on solution dictionary, with their own
+    // exclusions by length; a domain cardinality is its matching words
+    // count, only told apart up to 2
+    map<uint32_t, IDBitmap> solExclusions;
     vector<Word*> solWords(wordsNum, (Word*) NULL);
+    vector<uint32_t> solCounts(wordsNum, 0);
     for (wi = 0; wi < wordsNum; ++wi) {
         const Word* const w = m_model->getWord(wi);
 
         // solution dictionary, same definition reference
-        solWords[wi] = new Word(&solDict, w->getDefinition());
-        solWords[wi]->doMatch();
+        solWords[wi] = new Word(&solDict, w->getDefinition(),
+                                &solExclusions[w->getLength()]);
+        solCounts[wi] = solWords[wi]->countMatchings(2);
     }
 
     // checks for 1-choice constraint at each filling stage
@@ -128,28 +466,36 @@ bool Compiler::isDeterministicSolution() const
     for (wi = 0; wi < wordsNum; ++wi) {
 
         // first word having 1-element domain
-        swIt = find_if(solWords.begin(), solWords.end(), IsSimpleDomain());
+        uint32_t sWi;
+        for (sWi = 0; sWi < wordsNum; ++sWi) {
+            if (solWords[sWi] && (solCounts[sWi] == 1)) {
+                break;
+            }
+        }
 
         // no 1-element domains implies non-determinism
-        if (swIt == solWords.end()) {
+        if (sWi == wordsNum) {
             success = false;
             break;
         }
 
-        // computes chosen word index and gets related object
-        const uint32_t sWi = (uint32_t)distance(solWords.begin(), swIt);
-        Word* const sw = solWords[sWi];
+        // gets chosen word object
+        swIt = solWords.begin() + sWi;
+        Word* const sw = *swIt;
 
-        // gets matchings object to reach domain only-value
-        const uint32_t chosenID = sw->getID();
-        const string& chosen = sw->get();
+        // matches only now to reach domain only-value (the pattern may
+        // still be partial, so not through Word::getID())
+        sw->doMatch();
+        const MatchingResult* const swRes = sw->getMatchingResult();
+        const uint32_t chosenID = swRes->getFirstID();
+        const string chosen = swRes->getWord(chosenID);
 
         // assigns domain value to the word
         sw->set(chosen);
 
         // removes value from domains of words of same length
-        const set<uint32_t>& slWords = m_model->getWordsByLength(sw->getLength());
-        set<uint32_t>::const_iterator slwIt;
+        const PackedRange<uint32_t> slWords = m_model->getWordsByLength(sw->getLength());
+        PackedRange<uint32_t>::const_iterator slwIt;
         for (slwIt = slWords.begin(); slwIt != slWords.end(); ++slwIt) {
             const uint32_t slWi = *slwIt;
 
@@ -162,15 +508,15 @@ bool Compiler::isDeterministicSolution() const
 
                     // excludes chosen value for sw from slw
                     slw->exclude(chosenID);
-                    slw->doMatch();
+                    solCounts[slWi] = slw->countMatchings(2);
                 }
             }
         }
 
         // updates crossing words
-        const list<pair<uint32_t, WordCrossing> >& neighbours =
+        const PackedRange<pair<uint32_t, WordCrossing> > neighbours =
             m_model->getWordNeighbours(sWi);
-        list<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
+        PackedRange<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
         for (nbIt = neighbours.begin(); nbIt != neighbours.end(); ++nbIt) {
             Word* const cw = solWords[nbIt->first];
 
@@ -183,7 +529,7 @@ bool Compiler::isDeterministicSolution() const
 
                 // updates shared letter
                 cw->setAt(cwPos, sw->getAt(swPos));
-                cw->doMatch();
+                solCounts[nbIt->first] = cw->countMatchings(2);
             }
         }
 
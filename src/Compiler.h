@@ -6,6 +6,7 @@
 #ifndef __COMPILER_H
 #define __COMPILER_H
 
+#include "Budget.h"
 #include "Model.h"
 #include "Output.h"
 #include "Walk.h"
@@ -20,7 +21,9 @@ namespace crucio
             FAILURE_IMPOSSIBLE,
             FAILURE_OVERCONSTRAINED,
             FAILURE_ND_GRID,
-            FAILURE_TIMEOUT
+            FAILURE_TIMEOUT,
+            FAILURE_BUDGET,
+            FAILURE_CANCELLED
         };
 
         Compiler();
@@ -31,7 +34,10 @@ namespace crucio
             m_unique = unique;
         }
         bool isUnique() const {
-            return m_unique;
+
+            // a deterministic solution can't repeat words, as the solver
+            // excludes every placed word from the other slots
+            return (m_unique || m_deterministic);
         }
 
         // deterministic solution constraint
@@ -42,17 +48,45 @@ namespace crucio
             return m_deterministic;
         }
         
-        // timeout constraint
-        void setTimeoutSeconds(const unsigned timeoutSeconds) {
-            m_timeoutSeconds = timeoutSeconds;
+        // deadline, nodes/backtracks limits and cancellation
+        Budget& getBudget() {
+            return m_budget;
+        }
+        const Budget& getBudget() const {
+            return m_budget;
+        }
+
+        // value choice randomness
+        void setSeed(const uint32_t seed) {
+            m_random.setSeed(seed);
+        }
+
+        // solutions enumeration: with a sink, every solution is streamed
+        // as found and search resumes from it, until the sink refuses
+        // more, limit solutions are found (0 = all) or search space is
+        // exhausted; fills differ in at least minDistance letters
+        void setSolutionSink(SolutionSink* const sink) {
+            m_sink = sink;
+        }
+        void setSolutionLimit(const uint32_t limit) {
+            m_solutionLimit = limit;
+        }
+        void setMinDistance(const uint32_t minDistance) {
+            m_minDistance = minDistance;
         }
-        unsigned getTimeoutSeconds() {
-            return m_timeoutSeconds;
+        uint32_t getSolutionsNum() const {
+            return m_solutionsNum;
         }
 
         // algorithm execution
         Result compile(Model* const model, const Walk& walk);
 
+        // true if an interrupted compile() left the deepest partial
+        // fill found so far in the model
+        bool isPartial() const {
+            return m_partial;
+        }
+
     protected:
         
         // TODO: convert subclasses to interface implementations
@@ -62,54 +96,148 @@ namespace crucio
         virtual void reset() = 0;
         virtual Compiler::Result compileFrom(const uint32_t i) = 0;
         
-        // timeout to be checked periodically in subclasses
-        bool isTimeout() const
-        {
-            // 0 = no timeout
-            if (m_timeoutSeconds == 0) {
-                return false;
+        // determinism pruning, false if completed word wi makes the
+        // solution non-deterministic whatever the remaining words
+        bool isDistinguishable(const uint32_t wi) const;
+
+        // value ordering by word scores, candidates being matchings of
+        // length len with loaded IDs first (best scores first) and added
+        // IDs trailing in any order: the ones with the best score, none
+        // if length is unscored
+        template <typename Iterator>
+        void getBestCandidates(const uint32_t len, Iterator first, Iterator last,
+                               std::vector<Iterator>* const best) const {
+            const Dictionary* const d = m_model->getDictionary();
+            best->clear();
+            if (!d->isScored(len)) {
+                return;
+            }
+            const uint32_t baseSize = d->getBaseSize(len);
+            Iterator added = last;
+            while (added != first) {
+                Iterator prev = added;
+                if (*--prev < baseSize) {
+                    break;
+                }
+                added = prev;
+            }
+
+            // leading loaded block, then any added word scoring as high
+            uint32_t bestScore = 0;
+            for (Iterator it = first; it != added; ++it) {
+                const uint32_t score = d->getScore(len, *it);
+                if (!best->empty() && (score != bestScore)) {
+                    break;
+                }
+                bestScore = score;
+                best->push_back(it);
+            }
+            for (Iterator it = added; it != last; ++it) {
+                const uint32_t score = d->getScore(len, *it);
+                if (!best->empty() && (score < bestScore)) {
+                    continue;
+                }
+                if (best->empty() || (score > bestScore)) {
+                    best->clear();
+                    bestScore = score;
+                }
+                best->push_back(it);
             }
+        }
+
+        // letters of domain whose best matchings score highest across
+        // the words crossing letter li, whole domain if unscored
+        ABMask getPreferredLetters(const uint32_t li, const ABMask domain) const;
 
-            // elapsed millis so far
-            const time_t elapsedSeconds = time(NULL) - m_compileSeconds;
-            *crucio_vout << "elapsed seconds = " << elapsedSeconds << " (timeout = " << m_timeoutSeconds << ")" << std::endl;
+        // letters allowed by all words li belongs to
+        ABMask getLetterDomain(const uint32_t li) const;
 
-            // timeout millis elapsed
-            return (elapsedSeconds > m_timeoutSeconds);
+        // budget to be charged by subclasses once per value tried and
+        // once per backtrack, true when search must stop
+        bool isInterrupted() {
+            return m_budget.onNode();
+        }
+        bool isInterruptedOnBacktrack() {
+            return m_budget.onBacktrack();
         }
 
-    private:
+        // failure matching budget exhaustion
+        Compiler::Result getInterruption() const;
 
-        // used by determinism check
-        class IsSimpleDomain
-        {
-        public:
+        // to be called by subclasses on complete assignments (letters
+        // included), false when enumeration must go on
+        bool acceptSolution();
 
-            // <length, words-by-length> pair
-            bool operator()(const std::pair<uint32_t,
-                            std::set<uint32_t> >& lenWords) const {
-                return (lenWords.second.size() == 1);
-            }
+        // independent components along variables order, to be set by
+        // subclasses on configure
+        void configureComponents(const std::vector<uint32_t>& order,
+                                 const std::vector<uint32_t>& components);
+
+        // to be called when variable i backtracks; true if i starts an
+        // independent component, whose failure no earlier assignment can
+        // repair, so that search gives up at once
+        bool failComponent(const uint32_t i);
+        bool isComponentFailed() const {
+            return m_componentFailed;
+        }
 
-            // a pattern's domain cardinality is matching words count
-            bool operator()(const Word* const w) const {
-                return (w && (w->getMatchingResult()->getSize() == 1));
+        // anytime search, to be called by subclasses after a successful
+        // assignment with the number of assigned variables; the deepest
+        // assignment is saved and restored on interruption
+        void saveBest(const uint32_t depth) {
+            if (depth > m_bestDepth) {
+                m_bestDepth = depth;
+                m_model->saveLetters(&m_bestLetters);
             }
-        };
+        }
+
+    private:
 
         // parameters
         bool m_unique;
         bool m_deterministic;
-        time_t m_compileSeconds;
-        unsigned m_timeoutSeconds;
+        Budget m_budget;
+
+        // enumeration
+        SolutionSink* m_sink;
+        uint32_t m_solutionLimit;
+        uint32_t m_minDistance;
+        uint32_t m_solutionsNum;
+        std::vector<std::vector<char> > m_solutions;
+        std::vector<char> m_letters;
+
+        // true if letters are minDistance apart from previous solutions
+        bool isDiverse(const std::vector<char>& letters) const;
+
+        // components starts by order
+        std::vector<bool> m_componentStarts;
+        bool m_componentFailed;
+
+        // best partial fill
+        uint32_t m_bestDepth;
+        std::vector<char> m_bestLetters;
+        bool m_partial;
+
+        // restores best partial fill on interruption
+        Compiler::Result interrupt(const Compiler::Result result);
 
         // determinism check
         bool isDeterministicSolution() const;
+        static bool agreeOnCrossings(const std::string& v1,
+                                     const std::string& v2,
+                                     const PackedRange<std::pair<uint32_t, WordCrossing> > neighbours);
+
+        // preferred letters helper
+        bool fitsCells(const uint32_t len, const uint32_t id,
+                       const std::vector<std::pair<uint32_t, ABMask> >& cells) const;
 
     protected:
 
         // model reference
         Model* m_model;
+
+        // pseudorandom generator for value choice
+        Random m_random;
     };
 }
 
@@ -3,35 +3,479 @@
 // License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
 //
 
+#include <new>
+
+#include "Arena.h"
 #include "Dictionary.h"
+#include "Parallel.h"
+#include "Word.h"
 
 using namespace crucio;
 using namespace std;
 
 /* Dictionary */
 
-Dictionary::Dictionary(const Alphabet alphabet, Matcher* const matcher) :
+// overlay word added or banned
+class OverlayEdit
+{
+public:
+    OverlayEdit(const string& word, const bool added, const uint32_t score) :
+        m_word(word),
+        m_added(added),
+        m_score(score) {
+    }
+
+    string m_word;
+    bool m_added;
+    uint32_t m_score;
+};
+
+// overlay folding, owns a snapshot of the overlay it started from
+class Dictionary::Compaction
+{
+public:
+    Compaction(const WordSetIndex* const base, const Overlay& overlay) :
+        m_base(base),
+        m_overlay(overlay),
+        m_index(NULL),
+        m_journal(),
+        m_task() {
+    }
+    ~Compaction() {
+        m_task.join();
+        delete m_index;
+    }
+
+    // read-only until joined
+    const WordSetIndex* const m_base;
+    const Overlay m_overlay;
+
+    // compacted index
+    WordSetIndex* m_index;
+
+    // edits after snapshot, to replay
+    std::vector<OverlayEdit> m_journal;
+
+    ParallelTask m_task;
+};
+
+// true if word agrees with every letter in pattern
+static bool isMatching(const string& pattern, const string& word)
+{
+    for (uint32_t i = 0; i < pattern.length(); ++i) {
+        if ((pattern[i] != ANY_CHAR) && (pattern[i] != word[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// true if pattern has no letters
+static bool isWild(const string& pattern)
+{
+    return (pattern.find_first_not_of(ANY_CHAR) == string::npos);
+}
+
+Dictionary::Dictionary(const SymbolTable& symbols, Matcher* const matcher) :
     m_matcher(matcher),
-    m_index(new WordSetIndex(alphabet, MIN_LENGTH, MAX_LENGTH))
+    m_index(new WordSetIndex(symbols)),
+    m_base(NULL),
+    m_filter(NULL),
+    m_overlay(),
+    m_compaction(NULL)
 {
 
     // load index through matcher
     loadIndex();
 }
 
+Dictionary::Dictionary(const Dictionary* const base, Matcher* const matcher,
+                       const WordFilter* const filter) :
+    m_matcher(matcher),
+    m_index(base->m_index),
+    m_base(base),
+    m_filter(filter),
+    m_overlay(),
+    m_compaction(NULL)
+{
+
+    // matches on base words, no copy
+    m_matcher->resetIndex(m_index);
+    m_matcher->setFilter(m_filter);
+}
+
 Dictionary::~Dictionary()
 {
-    delete m_index;
+    delete m_compaction;
+    if (!m_base) {
+        delete m_index;
+    }
 }
 
-MatchingResult* Dictionary::createMatchingResult(const uint32_t len) const
+MatchingResult* Dictionary::createMatchingResult(const uint32_t len,
+                                                 Arena* const arena) const
 {
+    if (arena) {
+        return new (arena->allocate(sizeof(MatchingResult)))
+               MatchingResult(this, len);
+    }
     return new MatchingResult(this, len);
 }
 
-void Dictionary::destroyMatchingResult(MatchingResult* const res) const
+void Dictionary::destroyMatchingResult(MatchingResult* const res,
+                                       const bool placed) const
 {
-    delete res;
+    if (placed) {
+        res->~MatchingResult();
+    } else {
+        delete res;
+    }
+}
+
+/* overlay */
+
+uint32_t Dictionary::addWord(const string& word, const uint32_t score)
+{
+    string upperWord = word;
+    if (!isValidWord(&upperWord)) {
+        return UINT_MAX;
+    }
+    if (m_compaction) {
+        m_compaction->m_journal.push_back(OverlayEdit(upperWord, true, score));
+    }
+
+    const uint32_t len = (uint32_t)upperWord.length();
+    Overlay::Layer* layer = m_overlay.getLayer(len);
+
+    // already loaded, banned at most
+    const uint32_t baseID = getBaseID(upperWord);
+    if (baseID != UINT_MAX) {
+        if (layer) {
+            layer->m_banned.reset(baseID);
+        }
+        return baseID;
+    }
+
+    // already added, banned at most
+    layer = m_overlay.createLayer(len);
+    map<string, uint32_t>::const_iterator aIt = layer->m_addedIDs.find(upperWord);
+    if (aIt != layer->m_addedIDs.end()) {
+        layer->m_banned.reset(aIt->second);
+        return aIt->second;
+    }
+
+    // a score other than the loaded (or first added) one ranks words
+    const uint32_t baseSize = getBaseSize(len);
+    const uint32_t refScore = (baseSize > 0 ? getScore(len, 0) :
+                               layer->m_addedScores.empty() ? score :
+                               layer->m_addedScores[0]);
+    if (score != refScore) {
+        layer->m_scored = true;
+    }
+
+    const uint32_t id = baseSize + (uint32_t)layer->m_added.size();
+    layer->m_added.push_back(upperWord);
+    layer->m_addedScores.push_back(score);
+    layer->m_addedIDs.insert(make_pair(upperWord, id));
+    return id;
+}
+
+bool Dictionary::banWord(const string& word)
+{
+    string upperWord = word;
+    if (!isValidWord(&upperWord)) {
+        return false;
+    }
+
+    const uint32_t len = (uint32_t)upperWord.length();
+    uint32_t id = getBaseID(upperWord);
+    if (id == UINT_MAX) {
+        const Overlay::Layer* const layer = m_overlay.getLayer(len);
+        if (!layer) {
+            return false;
+        }
+        map<string, uint32_t>::const_iterator aIt = layer->m_addedIDs.find(upperWord);
+        if (aIt == layer->m_addedIDs.end()) {
+            return false;
+        }
+        id = aIt->second;
+    }
+    if (m_compaction) {
+        m_compaction->m_journal.push_back(OverlayEdit(upperWord, false, 0));
+    }
+
+    m_overlay.createLayer(len)->m_banned.set(id);
+    return true;
+}
+
+void Dictionary::startCompaction()
+{
+    if (m_compaction || m_base) {
+        return;
+    }
+
+    m_compaction = new Compaction(m_index, m_overlay);
+    m_compaction->m_task.start(compact, m_compaction);
+}
+
+bool Dictionary::finishCompaction()
+{
+    if (!m_compaction) {
+        return false;
+    }
+    m_compaction->m_task.join();
+
+    // new base, results and cached matchings refer to previous IDs
+    delete m_index;
+    m_index = m_compaction->m_index;
+    m_compaction->m_index = NULL;
+    m_overlay.clear();
+    m_matcher->resetIndex(m_index);
+
+    // replays edits made while compacting
+    vector<OverlayEdit> journal;
+    journal.swap(m_compaction->m_journal);
+    delete m_compaction;
+    m_compaction = NULL;
+
+    vector<OverlayEdit>::const_iterator jIt;
+    for (jIt = journal.begin(); jIt != journal.end(); ++jIt) {
+        if (jIt->m_added) {
+            addWord(jIt->m_word, jIt->m_score);
+        } else {
+            banWord(jIt->m_word);
+        }
+    }
+    return true;
+}
+
+// visible base word, UINT_MAX if missing or filtered out
+uint32_t Dictionary::getBaseID(const string& word) const
+{
+    const uint32_t len = (uint32_t)word.length();
+    const WordSet* const ws = m_index->getWordSet(len);
+    if (!ws) {
+        return UINT_MAX;
+    }
+
+    const uint32_t id = ws->getWordID(word);
+    if ((id != UINT_MAX) && m_filter && !m_filter->isAllowed(len, id)) {
+        return UINT_MAX;
+    }
+    return id;
+}
+
+// same check as matchers (normalizes word to alphabet symbols)
+bool Dictionary::isValidWord(string* const word) const
+{
+    if (word->length() < MIN_LENGTH) {
+        return false;
+    }
+    return getSymbols().normalize(word);
+}
+
+bool Dictionary::getOverlayMatchings(Word* const word) const
+{
+    const bool matched = m_matcher->getMatchings(m_index, word);
+
+    // untouched length
+    const uint32_t len = word->getLength();
+    const Overlay::Layer* const layer = m_overlay.getLayer(len);
+    if (!layer) {
+        return matched;
+    }
+
+    const string& pattern = word->get();
+    MatchingResult* const res = word->getMatchings();
+    const IDBitmap& banned = layer->m_banned;
+    const uint32_t baseSize = getBaseSize(len);
+
+    // drops banned base IDs, results are only rebuilt if any is found
+    bool anyBanned = false;
+    uint32_t id;
+    for (id = banned.getNext(0); (id < baseSize) && !anyBanned;
+            id = banned.getNext(id + 1)) {
+        anyBanned = binary_search(res->getIDs().begin(), res->getIDs().end(), id);
+    }
+    if (anyBanned) {
+        const vector<uint32_t> ids = res->getIDs();
+        res->clear();
+        res->reserve((uint32_t)ids.size());
+
+        vector<uint32_t>::const_iterator idIt;
+        for (idIt = ids.begin(); idIt != ids.end(); ++idIt) {
+            if (!banned.test(*idIt)) {
+                res->addID(*idIt);
+            }
+        }
+    }
+
+    // appends added words, IDs keep ascending; wild patterns ignore
+    // exclusions as in matchers
+    const bool wild = isWild(pattern);
+    const IDBitmap& exclusions = word->getExclusions();
+    for (uint32_t ai = 0; ai < layer->m_added.size(); ++ai) {
+        id = baseSize + ai;
+        if (banned.test(id) || (!wild && exclusions.test(id))) {
+            continue;
+        }
+        if (isMatching(pattern, layer->m_added[ai])) {
+            res->addID(id);
+        }
+    }
+
+    return !res->isEmpty();
+}
+
+bool Dictionary::getOverlayPossible(Word* const word) const
+{
+    // untouched length
+    const uint32_t len = word->getLength();
+    if (!m_overlay.getLayer(len)) {
+        return m_matcher->getPossible(m_index, word);
+    }
+
+    const MatchingResult* const res = word->getMatchings();
+    vector<ABMask>& possibleVector = word->getAllowed();
+    uint32_t pos;
+
+    // initially empty letter masks
+    for (pos = 0; pos < len; ++pos) {
+        possibleVector[pos].reset();
+    }
+    if (res->isEmpty()) {
+        return false;
+    }
+
+    // masks already computed for these results
+    if (!res->getMasks().empty()) {
+        possibleVector = res->getMasks();
+        return true;
+    }
+
+    // base word set masks would include banned words, letters are
+    // gathered word by word instead
+    const SymbolTable& symbols = getSymbols();
+    const vector<uint32_t>& ids = res->getIDs();
+    vector<uint32_t>::const_iterator idIt;
+    for (idIt = ids.begin(); idIt != ids.end(); ++idIt) {
+        const string matchedWord = getWord(len, *idIt);
+        for (pos = 0; pos < len; ++pos) {
+            possibleVector[pos].set(symbols.getIndex(matchedWord[pos]));
+        }
+    }
+
+    // shared with any other holder of these results
+    res->saveMasks(possibleVector);
+
+    return true;
+}
+
+uint32_t Dictionary::countOverlayMatchings(const Word* const word,
+                                           const uint32_t limit) const
+{
+    // untouched length
+    const uint32_t len = word->getLength();
+    const Overlay::Layer* const layer = m_overlay.getLayer(len);
+    if (!layer) {
+        return m_matcher->countMatchings(m_index, word, limit);
+    }
+    if (limit == 0) {
+        return 0;
+    }
+
+    const string& pattern = word->get();
+    const IDBitmap& banned = layer->m_banned;
+    const IDBitmap& exclusions = word->getExclusions();
+    const bool wild = isWild(pattern);
+    const uint32_t baseSize = getBaseSize(len);
+
+    // base count is exact below the raised limit, otherwise at least
+    // limit words are left whatever the banned ones
+    const uint32_t bannedNum = banned.count();
+    const uint32_t baseLimit = (limit > UINT_MAX - bannedNum ?
+                                UINT_MAX : limit + bannedNum);
+    uint32_t count = m_matcher->countMatchings(m_index, word, baseLimit);
+    if ((count == baseLimit) && (bannedNum > 0)) {
+        return limit;
+    }
+
+    // banned base words that were counted
+    uint32_t id;
+    for (id = banned.getNext(0); id < baseSize; id = banned.getNext(id + 1)) {
+        if ((wild || !exclusions.test(id)) &&
+                isMatching(pattern, getWord(len, id))) {
+            --count;
+        }
+    }
+
+    // added words
+    for (uint32_t ai = 0; (ai < layer->m_added.size()) && (count < limit); ++ai) {
+        id = baseSize + ai;
+        if (banned.test(id) || (!wild && exclusions.test(id))) {
+            continue;
+        }
+        if (isMatching(pattern, layer->m_added[ai])) {
+            ++count;
+        }
+    }
+
+    return min(count, limit);
+}
+
+// folds base words and added words minus banned ones
+void Dictionary::compact(const uint32_t, void* const context)
+{
+    Compaction* const compaction = (Compaction*) context;
+    const WordSetIndex* const base = compaction->m_base;
+    const Overlay& overlay = compaction->m_overlay;
+    WordSetIndex* const index = new WordSetIndex(base->getSymbols());
+
+    const uint32_t lengthBound = max(base->getLengthBound(),
+                                     overlay.getLengthBound());
+    for (uint32_t len = 0; len < lengthBound; ++len) {
+        const WordSet* const ws = base->getWordSet(len);
+        const Overlay::Layer* const layer = overlay.getLayer(len);
+        const uint32_t baseSize = (ws ? ws->getSize() : 0);
+        vector<string> words;
+        vector<uint32_t> scores;
+        uint32_t id;
+
+        words.reserve(baseSize + (layer ? layer->m_added.size() : 0));
+        scores.reserve(words.capacity());
+        for (id = 0; id < baseSize; ++id) {
+            if (!layer || !layer->m_banned.test(id)) {
+                words.push_back(ws->getWord(id));
+                scores.push_back(ws->getScore(id));
+            }
+        }
+        if (layer) {
+            for (id = 0; id < layer->m_added.size(); ++id) {
+                if (!layer->m_banned.test(baseSize + id)) {
+                    words.push_back(layer->m_added[id]);
+                    scores.push_back(layer->m_addedScores[id]);
+                }
+            }
+        }
+
+        // added words take their place by score
+        orderWords(&words, &scores);
+
+        if (words.empty()) {
+            continue;
+        }
+#ifdef CRUCIO_C_ARRAYS
+        index->createWordSet(len)->load(words, scores);
+#else
+        WordSet* const newWs = index->createWordSet(len);
+        vector<string>::const_iterator wIt;
+        for (wIt = words.begin(); wIt != words.end(); ++wIt) {
+            newWs->insert(*wIt);
+        }
+#endif
+    }
+
+    compaction->m_index = index;
 }
 
 /* <global> */
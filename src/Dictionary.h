@@ -7,10 +7,13 @@
 #define __DICTIONARY_H
 
 #include "common.h"
+#include "Overlay.h"
+#include "WordFilter.h"
 #include "WordSet.h"
 
 namespace crucio
 {
+    class Arena;
     class Word;
     class MatchingResult;
 
@@ -25,6 +28,16 @@ namespace crucio
         // delegated index loading
         virtual void loadIndex(WordSetIndex* const wsIndex) = 0;
 
+        // index replaced by a compacted one, anything derived from the
+        // previous IDs is stale
+        virtual void resetIndex(WordSetIndex* const wsIndex) {
+        }
+
+        // restricts matchings to the allowed IDs (NULL = all), applied
+        // while scanning the index
+        virtual void setFilter(const WordFilter* const filter) {
+        }
+
         // return words matching a pattern, excluding given IDs (optional)
         virtual bool getMatchings(WordSetIndex* const wsIndex,
                                   Word* const word) = 0;
@@ -33,6 +46,22 @@ namespace crucio
         virtual bool getPossible(WordSetIndex* const wsIndex,
                                  Word* const word) = 0;
 
+        // number of words matching a pattern, counting stops at limit
+        // and leaves matching result untouched
+        virtual uint32_t countMatchings(WordSetIndex* const wsIndex,
+                                        const Word* const word,
+                                        const uint32_t limit) = 0;
+
+        // true if any word matches a pattern
+        virtual bool anyMatch(WordSetIndex* const wsIndex,
+                              const Word* const word) {
+            return (countMatchings(wsIndex, word, 1) > 0);
+        }
+
+        // true if words of length len can ever be matched
+        virtual bool supportsLength(const WordSetIndex* const wsIndex,
+                                    const uint32_t len) const = 0;
+
         // dynamic custom entries
         virtual uint32_t addCustomWord(const std::string& word) = 0;
         virtual const std::string& getCustomWord(const uint32_t id) const = 0;
@@ -47,24 +76,43 @@ namespace crucio
     {
     public:
         static const uint32_t MIN_LENGTH = 2;
-        static const uint32_t MAX_LENGTH = 32;
 
-        Dictionary(const Alphabet alphabet, Matcher* const matcher);
+        Dictionary(const SymbolTable& symbols, Matcher* const matcher);
+
+        // view on base words through filter, sharing the base index
+        // (base must outlive views and not compact meanwhile); matcher
+        // is the view own and isn't loaded
+        Dictionary(const Dictionary* const base, Matcher* const matcher,
+                   const WordFilter* const filter);
         ~Dictionary();
 
-        // proxy for MatchingResult ctors/dctors
-        MatchingResult* createMatchingResult(const uint32_t len) const;
-        void destroyMatchingResult(MatchingResult* const res) const;
+        // proxy for MatchingResult ctors/dctors, optionally placed in an
+        // arena (memory is then released along with the arena)
+        MatchingResult* createMatchingResult(const uint32_t len,
+                                             Arena* const arena = NULL) const;
+        void destroyMatchingResult(MatchingResult* const res,
+                                   const bool placed = false) const;
 
-        const Alphabet getAlphabet() const {
-            return m_index->getAlphabet();
+        const SymbolTable& getSymbols() const {
+            return m_index->getSymbols();
+        }
+
+        // loaded words, shared by views
+        const WordSetIndex* getIndex() const {
+            return m_index;
+        }
+        const WordFilter* getFilter() const {
+            return m_filter;
         }
+
+        // matchable words, filter and overlay included
         uint32_t getSize() const {
-            return m_index->getSize();
+            return (m_filter ? m_filter->getAllowedNum() : m_index->getSize()) +
+                   m_overlay.getAddedNum() - m_overlay.getBannedNum();
         }
         uint32_t getSize(const uint32_t len) const {
-            const WordSet* const ws = m_index->getWordSet(len);
-            return ws->getSize();
+            return (m_filter ? m_filter->getAllowedNum(len) : getBaseSize(len)) +
+                   m_overlay.getAddedNum(len) - m_overlay.getBannedNum(len);
         }
 
         //bool contains(const string& word) const {
@@ -73,9 +121,52 @@ namespace crucio
         //}
 
         const std::string getWord(const uint32_t len, const uint32_t id) const {
+            const uint32_t baseSize = getBaseSize(len);
+            if (id >= baseSize) {
+                return m_overlay.getLayer(len)->m_added[id - baseSize];
+            }
             const WordSet* const ws = m_index->getWordSet(len);
             return ws->getWord(id);
         }
+
+        // symbol index at position pos, loaded words read their column
+        uint32_t getLetterIndex(const uint32_t len, const uint32_t id,
+                                const uint32_t pos) const {
+            const uint32_t baseSize = getBaseSize(len);
+            if (id >= baseSize) {
+                return getSymbols().getIndex(m_overlay.getLayer(len)->m_added[id - baseSize][pos]);
+            }
+            const WordSet* const ws = m_index->getWordSet(len);
+#ifdef CRUCIO_C_ARRAYS
+            return ws->getColumn(pos)[id];
+#else
+            return getSymbols().getIndex(ws->getWord(id)[pos]);
+#endif
+        }
+
+        // word quality; loaded IDs ascend as scores descend, added
+        // words follow whatever their score
+        uint32_t getScore(const uint32_t len, const uint32_t id) const {
+            const uint32_t baseSize = getBaseSize(len);
+            if (id >= baseSize) {
+                return m_overlay.getLayer(len)->m_addedScores[id - baseSize];
+            }
+            const WordSet* const ws = m_index->getWordSet(len);
+            return ws->getScore(id);
+        }
+
+        // false if loaded and added words of length len share a score
+        bool isScored(const uint32_t len) const {
+            const WordSet* const ws = m_index->getWordSet(len);
+            const Overlay::Layer* const layer = m_overlay.getLayer(len);
+            return ((ws && ws->isScored()) || (layer && layer->m_scored));
+        }
+
+        // loaded words of length len, added words take IDs from here on
+        uint32_t getBaseSize(const uint32_t len) const {
+            const WordSet* const ws = m_index->getWordSet(len);
+            return (ws ? ws->getSize() : 0);
+        }
         //const uint32_t getWordID(const string& word) const {
         //    const WordSet* const ws = m_index->getWordSet(word.length());
         //    return ws->getWordID(word);
@@ -87,11 +178,34 @@ namespace crucio
             return m_matcher->loadIndex(m_index);
         }
         bool getMatchings(Word* const word) const {
+            if (!m_overlay.isEmpty()) {
+                return getOverlayMatchings(word);
+            }
             return m_matcher->getMatchings(m_index, word);
         }
         bool getPossible(Word* const word) const {
+            if (!m_overlay.isEmpty()) {
+                return getOverlayPossible(word);
+            }
             return m_matcher->getPossible(m_index, word);
         }
+        uint32_t countMatchings(const Word* const word,
+                                const uint32_t limit) const {
+            if (!m_overlay.isEmpty()) {
+                return countOverlayMatchings(word, limit);
+            }
+            return m_matcher->countMatchings(m_index, word, limit);
+        }
+        bool anyMatch(const Word* const word) const {
+            if (!m_overlay.isEmpty()) {
+                return (countOverlayMatchings(word, 1) > 0);
+            }
+            return m_matcher->anyMatch(m_index, word);
+        }
+        bool supportsLength(const uint32_t len) const {
+            return (m_matcher->supportsLength(m_index, len) ||
+                    (m_overlay.getAddedNum(len) > 0));
+        }
         uint32_t addCustomWord(const std::string& word) {
             return m_matcher->addCustomWord(word);
         }
@@ -105,13 +219,115 @@ namespace crucio
             return m_matcher->removeCustomWordID(id);
         }
 
+        /* overlay */
+
+        // adds a word past the loaded ones (or lifts its ban), returns
+        // its ID or UINT_MAX if not a valid word; models built earlier
+        // don't see overlay changes
+        uint32_t addWord(const std::string& word,
+                         const uint32_t score = DEFAULT_SCORE);
+
+        // drops a word from later matchings, false if unknown
+        bool banWord(const std::string& word);
+
+        const Overlay& getOverlay() const {
+            return m_overlay;
+        }
+
+        // folds overlay into a new index in the background; words are
+        // renumbered on swap, so finishCompaction() must be called with
+        // no models or views alive (edits made meanwhile are replayed on
+        // top); views never compact
+        void startCompaction();
+        bool finishCompaction();
+
     private:
+        class Compaction;
 
         // laoding/matching algorithm
         Matcher *const m_matcher;
 
-        // wordsets vector wrapper
+        // wordsets vector wrapper, owned unless a view
         WordSetIndex* m_index;
+        const Dictionary* const m_base;
+        const WordFilter* const m_filter;
+
+        // words added/banned over m_index
+        Overlay m_overlay;
+
+        // running compaction, if any
+        Compaction* m_compaction;
+
+        uint32_t getBaseID(const std::string& word) const;
+        bool isValidWord(std::string* const word) const;
+
+        // matcher results merged with overlay
+        bool getOverlayMatchings(Word* const word) const;
+        bool getOverlayPossible(Word* const word) const;
+        uint32_t countOverlayMatchings(const Word* const word,
+                                       const uint32_t limit) const;
+
+        // background compaction (Compaction context)
+        static void compact(const uint32_t i, void* const context);
+
+        // non copyable
+        Dictionary(const Dictionary&);
+        Dictionary& operator=(const Dictionary&);
+    };
+
+    // reference counted matching IDs, shared by matching results and
+    // the match cache; letter masks are saved along once computed
+    class IDBuffer
+    {
+    public:
+        IDBuffer() :
+            m_IDs(),
+            m_masks(),
+            m_refs(1) {
+        }
+
+        std::vector<uint32_t>& getIDs() {
+            return m_IDs;
+        }
+        const std::vector<uint32_t>& getIDs() const {
+            return m_IDs;
+        }
+        std::vector<ABMask>& getMasks() {
+            return m_masks;
+        }
+        const std::vector<ABMask>& getMasks() const {
+            return m_masks;
+        }
+
+        // references (thread-safe counting, contents are not)
+        void retain() {
+            incrementRefs(&m_refs);
+        }
+        void release() {
+            if (decrementRefs(&m_refs) == 0) {
+                delete this;
+            }
+        }
+        bool isShared() const {
+            return (m_refs > 1);
+        }
+
+        // unshared copy of IDs and masks
+        IDBuffer* copy() const {
+            IDBuffer* const buffer = new IDBuffer();
+            buffer->m_IDs = m_IDs;
+            buffer->m_masks = m_masks;
+            return buffer;
+        }
+
+    private:
+        std::vector<uint32_t> m_IDs;
+        std::vector<ABMask> m_masks;
+        volatile uint32_t m_refs;
+
+        // non copyable
+        IDBuffer(const IDBuffer&);
+        IDBuffer& operator=(const IDBuffer&);
     };
 
     class MatchingResult
@@ -119,6 +335,10 @@ namespace crucio
     public:
         friend class Dictionary;
 
+        ~MatchingResult() {
+            m_buffer->release();
+        }
+
         // fixed words length
         uint32_t getWordsLength() const {
             return m_wordsLength;
@@ -126,40 +346,74 @@ namespace crucio
 
         // results
         uint32_t getSize() const {
-            return (uint32_t)m_IDs.size();
+            return (uint32_t)m_buffer->getIDs().size();
         }
         bool isEmpty() const {
-            return m_IDs.empty();
+            return m_buffer->getIDs().empty();
         }
         bool isFull() const {
-            return (m_IDs.size() == m_dictionary->getSize(m_wordsLength));
+            return (getSize() == m_dictionary->getSize(m_wordsLength));
         }
         const std::vector<uint32_t>& getIDs() const {
-            return m_IDs;
+            return m_buffer->getIDs();
         }
         uint32_t getFirstID() const {
-            if (m_IDs.empty()) {
+            if (isEmpty()) {
                 return UINT_MAX;
             }
-            return *m_IDs.begin();
+            return m_buffer->getIDs().front();
         }
 
-        // results modification
+        // results modification (copy on write)
         void clear() {
-            m_IDs.clear();
+            if (m_buffer->isShared()) {
+                m_buffer->release();
+                m_buffer = new IDBuffer();
+            } else {
+                m_buffer->getIDs().clear();
+                m_buffer->getMasks().clear();
+            }
         }
         void reserve(const uint32_t size) {
-            m_IDs.reserve(size);
+            detach();
+            m_buffer->getIDs().reserve(size);
         }
         void addID(const uint32_t id) {
-            m_IDs.push_back(id);
+            detach();
+            m_buffer->getIDs().push_back(id);
+        }
+
+        // shared buffer, replaces current results
+        IDBuffer* getBuffer() const {
+            return m_buffer;
+        }
+        void share(IDBuffer* const buffer) {
+            buffer->retain();
+            m_buffer->release();
+            m_buffer = buffer;
+        }
+
+        // private copy of a buffer, replaces current results
+        void assign(const IDBuffer* const buffer) {
+            IDBuffer* const copy = buffer->copy();
+            m_buffer->release();
+            m_buffer = copy;
+        }
+
+        // letter masks of these results, empty if never computed
+        const std::vector<ABMask>& getMasks() const {
+            return m_buffer->getMasks();
+        }
+        void saveMasks(const std::vector<ABMask>& masks) const {
+            m_buffer->getMasks() = masks;
         }
 
         // external set operations
         void saveIDsUnion(std::set<uint32_t>* const dest) const {
             std::vector<uint32_t>::const_iterator idIt;
 
-            for (idIt = m_IDs.begin(); idIt != m_IDs.end(); ++idIt) {
+            const std::vector<uint32_t>& ids = m_buffer->getIDs();
+            for (idIt = ids.begin(); idIt != ids.end(); ++idIt) {
                 dest->insert(*idIt);
             }
         }
@@ -175,7 +429,7 @@ namespace crucio
                 const uint32_t sID = *sIDIt;
 
                 // removes and saves unshared values
-                if (!std::binary_search(m_IDs.begin(), m_IDs.end(), sID)) {
+                if (!std::binary_search(getIDs().begin(), getIDs().end(), sID)) {
                     dest->erase(sIDIt);
                     removed->insert(sID);
                 }
@@ -190,12 +444,24 @@ namespace crucio
     private:
         const Dictionary* const m_dictionary;
         const uint32_t m_wordsLength;
-        std::vector<uint32_t> m_IDs;
+        IDBuffer* m_buffer;
 
         MatchingResult(const Dictionary* const d, const uint32_t len) :
             m_dictionary(d),
             m_wordsLength(len),
-            m_IDs() {
+            m_buffer(new IDBuffer()) {
+        }
+
+        // own copy before modification
+        void detach() {
+            if (m_buffer->isShared()) {
+                IDBuffer* const copy = new IDBuffer();
+                copy->getIDs() = m_buffer->getIDs();
+                m_buffer->release();
+                m_buffer = copy;
+            } else {
+                m_buffer->getMasks().clear();
+            }
         }
     };
 }
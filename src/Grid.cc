@@ -457,11 +457,6 @@ void Grid::initGrid(const char** charsGrid,
             }
         }
 
-        // unconnected cell graph (IMPORTANT: AFTER calculateNearCells())
-        if (!isConnected()) {
-            throw GridException("grid: unreachable cells");
-        }
-
         // IMPORTANT: computes crossing definitions (definitions graph)
         for (defIt = m_acrossDefinitions.begin(); defIt !=
                 m_acrossDefinitions.end(); ++defIt) {
@@ -518,41 +513,6 @@ Grid::~Grid()
     }
 }
 
-bool Grid::isConnected() const
-{
-    const Cell* const firstCl = getFirstNonBlackCell();
-    set<const Cell*, CellCompare> visited;
-
-    // connected if search reaches all white or fixed cells
-    return (getReachableFrom(firstCl, &visited) == m_whiteCells + m_fixedCells);
-}
-
-uint32_t Grid::getReachableFrom(const Cell* const cl,
-                                set<const Cell*, CellCompare>* const visited)
-{
-    uint32_t reachable = 0;
-
-    // skips visited cells
-    const pair<set<const Cell*,
-          CellCompare>::iterator, bool> res = visited->insert(cl);
-    if (!res.second) {
-        return 0;
-    }
-
-    // adds current
-    ++reachable;
-
-    // goes down recursively
-    const list<const Cell*>& nearCells = cl->getNearCells();
-    list<const Cell*>::const_iterator nClIt;
-    for (nClIt = nearCells.begin(); nClIt != nearCells.end(); ++nClIt) {
-        const Cell* const nCl = *nClIt;
-        reachable += getReachableFrom(nCl, visited);
-    }
-
-    return reachable;
-}
-
 /* <global> */
 
 ostream& operator<<(ostream& out, const CellAddress& ca)
@@ -53,8 +53,10 @@ namespace crucio
         static const char WHITE = '-';
         static const char BLACK = '#';
 
+        // non-ASCII bytes are fixed symbols of custom alphabets
         static bool isLegal(const char ch) {
-            return (strchr(sm_legalValues, ch) != NULL);
+            return ((strchr(sm_legalValues, ch) != NULL) ||
+                    ((unsigned char) ch >= 0x80));
         }
 
         // parent grid
@@ -288,7 +290,7 @@ namespace crucio
         const Definition* getFirstDefinition() const {
             const Cell* const firstCl = getFirstNonBlackCell();
 
-            // at least one of them is non-NULL since grid is connected
+            // at least one of them is non-NULL since no cell is isolated
             return (firstCl->getAcrossDef() ?
                     firstCl->getAcrossDef() : firstCl->getDownDef());
         }
@@ -310,8 +312,6 @@ namespace crucio
     private:
         void initGrid(const char** charsGrid,
                       const uint32_t rows, const uint32_t columns);
-        static uint32_t getReachableFrom(const Cell* const cl,
-                                         std::set<const Cell*, CellCompare>* const visited);
 
         const std::string m_filename;
         uint32_t m_rows;
@@ -326,9 +326,6 @@ namespace crucio
         std::vector<std::vector<Cell*> > m_cells;
         std::vector<Definition*> m_acrossDefinitions;
         std::vector<Definition*> m_downDefinitions;
-
-        // checks for isolated cells
-        bool isConnected() const;
     };
 }
 
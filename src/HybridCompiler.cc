@@ -0,0 +1,430 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include <algorithm>
+
+#include "HybridCompiler.h"
+
+using namespace crucio;
+using namespace std;
+
+const uint32_t HybridCompiler::DEFAULT_WORD_THRESHOLD;
+
+HybridCompiler::HybridCompiler() :
+    m_wordThreshold(DEFAULT_WORD_THRESHOLD),
+    m_lettersRanks(),
+    m_wordsRanks(),
+    m_trail(),
+    m_exclusions(),
+    m_unassigned(0),
+    m_touched(),
+    m_symbols(NULL)
+{
+}
+
+Compiler::Result HybridCompiler::configure(const Walk& walk)
+{
+    vector<uint32_t> order;
+
+    // prepare alphabet conversions
+    m_symbols = &m_model->getSymbols();
+
+    // walk orders only break ties between equally cheap variables
+    walk.visitLetters(*m_model, &order);
+    Walk::getReverseOrder(order, &m_lettersRanks);
+    walk.visitWords(*m_model, &order);
+    Walk::getReverseOrder(order, &m_wordsRanks);
+
+    // letter-based domains, word matchings come along
+    m_model->computeLetterDomains();
+
+    return Compiler::SUCCESS;
+}
+
+void HybridCompiler::reset()
+{
+    m_model->reset();
+    m_trail.clear();
+    m_exclusions.clear();
+    m_touched.clear();
+
+    // fixed letters are never branched on
+    m_unassigned = 0;
+    for (uint32_t li = 0; li < m_model->getLettersNum(); ++li) {
+        if (m_model->getLetter(li)->get() == ANY_CHAR) {
+            ++m_unassigned;
+        }
+    }
+}
+
+Compiler::Result HybridCompiler::compileFrom(const uint32_t i)
+{
+    uint32_t li, wi;
+
+    // all letters instantiated?
+    if (m_unassigned == 0) {
+
+        // enumeration resumes from here as from a failure
+        if (acceptSolution()) {
+            return Compiler::SUCCESS;
+        }
+        return Compiler::FAILURE_IMPOSSIBLE;
+    }
+
+    // smallest letter domain
+    uint32_t bestLi = UINT_MAX;
+    ABMask bestDomain;
+    uint32_t bestCount = UINT_MAX;
+    for (li = 0; li < m_model->getLettersNum(); ++li) {
+        if (m_model->getLetter(li)->get() != ANY_CHAR) {
+            continue;
+        }
+
+        const ABMask domain = getLetterDomain(li);
+        const uint32_t count = domain.count();
+        if ((count < bestCount) || ((count == bestCount) &&
+                                    (m_lettersRanks[li] < m_lettersRanks[bestLi]))) {
+            bestLi = li;
+            bestDomain = domain;
+            bestCount = count;
+        }
+    }
+
+    // fewest matchings among incomplete words, a static dictionary is
+    // required to enumerate them
+    uint32_t bestWi = UINT_MAX;
+    uint32_t bestSize = UINT_MAX;
+    if (m_model->getDictionary()->getSize() > 0) {
+        for (wi = 0; wi < m_model->getWordsNum(); ++wi) {
+            const Word* const w = m_model->getWord(wi);
+            if (w->isComplete()) {
+                continue;
+            }
+
+            const uint32_t size = w->getMatchingResult()->getSize();
+            if ((size < bestSize) || ((size == bestSize) &&
+                                      (m_wordsRanks[wi] < m_wordsRanks[bestWi]))) {
+                bestWi = wi;
+                bestSize = size;
+            }
+        }
+    }
+
+    // whole word when few enough matchings are left
+    if (bestSize <= m_wordThreshold) {
+        return branchWord(bestWi, i);
+    }
+    return branchLetter(bestLi, bestDomain, i);
+}
+
+Compiler::Result HybridCompiler::branchLetter(const uint32_t li,
+                                              ABMask domainMask,
+                                              const uint32_t i)
+{
+    *crucio_vout << "domain for " << li << " = " <<
+                 m_symbols->getMaskString(domainMask) << endl;
+
+    const uint32_t trailMark = (uint32_t)m_trail.size();
+    const uint32_t exclusionsMark = (uint32_t)m_exclusions.size();
+
+    // iterates over domain
+    while (domainMask.any()) {
+
+        // search limits
+        if (isInterrupted()) {
+            return getInterruption();
+        }
+
+        // chooses value to assign
+#ifdef CRUCIO_BENCHMARK
+        const uint32_t vi = firstBit(domainMask.bits());
+#else
+        const uint32_t vi = randomBit(getPreferredLetters(li, domainMask).bits(),
+                                      &m_random);
+#endif
+        domainMask.reset(vi);
+        const char v = m_symbols->getSymbol(vi);
+
+        *crucio_vout << "letter " << li << " = '" << v << "'" << endl;
+
+        // tries to assign v to current variable
+        place(li, v);
+        if (!propagate()) {
+            undo(trailMark, exclusionsMark);
+            continue;
+        }
+
+        // deepest partial fill, by assigned letters
+        saveBest(m_model->getLettersNum() - m_unassigned);
+
+        // recursively solved?
+        const Compiler::Result result = compileFrom(i + 1);
+        if (result == Compiler::SUCCESS) {
+            return Compiler::SUCCESS;
+        }
+
+        // retires variable
+        undo(trailMark, exclusionsMark);
+
+        // interrupted rather than failed
+        if (result != Compiler::FAILURE_IMPOSSIBLE) {
+            return result;
+        }
+    }
+
+    *crucio_vout << "letter " << li << " ... BACKTRACK!" << endl;
+
+    // backtracks are charged too
+    if (isInterruptedOnBacktrack()) {
+        return getInterruption();
+    }
+
+    return Compiler::FAILURE_IMPOSSIBLE;
+}
+
+Compiler::Result HybridCompiler::branchWord(const uint32_t wi,
+                                            const uint32_t i)
+{
+    Word* const w = m_model->getWord(wi);
+    const uint32_t wLen = w->getLength();
+    const Dictionary* const d = m_model->getDictionary();
+
+    // candidates are copied, matchings change below; tried ones are
+    // dropped from the back, or skipped from the front when scored and
+    // loaded (added words trail, their order doesn't matter)
+    vector<uint32_t> candidates = w->getMatchingResult()->getIDs();
+    const bool scored = d->isScored(wLen);
+    const uint32_t baseSize = d->getBaseSize(wLen);
+    vector<vector<uint32_t>::iterator> best;
+    uint32_t first = 0;
+
+    *crucio_vout << "pattern for " << wi << " = \'" << w->get() <<
+                 "\' (" << candidates.size() << " matchings)" << endl;
+
+    const uint32_t trailMark = (uint32_t)m_trail.size();
+    const uint32_t exclusionsMark = (uint32_t)m_exclusions.size();
+
+    // iterates over matchings
+    while (first < candidates.size()) {
+
+        // search limits
+        if (isInterrupted()) {
+            return getInterruption();
+        }
+
+        // chooses value to assign
+#ifdef CRUCIO_BENCHMARK
+        const uint32_t ci = first;
+#else
+        getBestCandidates(wLen, candidates.begin() + first, candidates.end(), &best);
+        const uint32_t ci = (best.empty() ?
+                             first + m_random.next((uint32_t)candidates.size() - first) :
+                             (uint32_t)(best[m_random.next((uint32_t)best.size())] - candidates.begin()));
+#endif
+        const string v = d->getWord(wLen, candidates[ci]);
+
+        // a loaded ci is within the leading tied block, swapping it with
+        // the block head keeps scored candidates best first
+        if (scored && (candidates[ci] < baseSize)) {
+            swap(candidates[ci], candidates[first]);
+            ++first;
+        } else {
+            candidates[ci] = candidates.back();
+            candidates.pop_back();
+        }
+
+        *crucio_vout << "word " << wi << " = '" << v << "'" << endl;
+
+        // fills missing letters
+        const PackedRange<uint32_t> wordLetters = m_model->getWordLetters(wi);
+        for (uint32_t pos = 0; pos < wLen; ++pos) {
+            if (w->getAt(pos) == ANY_CHAR) {
+                place(wordLetters[pos], v[pos]);
+            }
+        }
+        if (!propagate()) {
+            undo(trailMark, exclusionsMark);
+            continue;
+        }
+
+        // deepest partial fill, by assigned letters
+        saveBest(m_model->getLettersNum() - m_unassigned);
+
+        // recursively solved?
+        const Compiler::Result result = compileFrom(i + 1);
+        if (result == Compiler::SUCCESS) {
+            return Compiler::SUCCESS;
+        }
+
+        // retires variable
+        undo(trailMark, exclusionsMark);
+
+        // interrupted rather than failed
+        if (result != Compiler::FAILURE_IMPOSSIBLE) {
+            return result;
+        }
+    }
+
+    *crucio_vout << "word " << wi << " ... BACKTRACK!" << endl;
+
+    // backtracks are charged too
+    if (isInterruptedOnBacktrack()) {
+        return getInterruption();
+    }
+
+    return Compiler::FAILURE_IMPOSSIBLE;
+}
+
+// sets letter on the trail, words are rematched by propagate()
+void HybridCompiler::place(const uint32_t li, const char v)
+{
+    m_model->getLetter(li)->set(v);
+    m_trail.push_back(li);
+    --m_unassigned;
+
+    const PackedRange<LetterPosition> letterWords = m_model->getLetterWords(li);
+    PackedRange<LetterPosition>::const_iterator lpIt;
+    for (lpIt = letterWords.begin(); lpIt != letterWords.end(); ++lpIt) {
+        const uint32_t wi = lpIt->getWordIndex();
+        m_model->getWord(wi)->setAt(lpIt->getPosition(), v);
+        m_touched.insert(wi);
+    }
+}
+
+// rematches touched words, false on any empty domain
+bool HybridCompiler::propagate()
+{
+    set<uint32_t> rematch;
+    set<uint32_t>::const_iterator wIt;
+    bool consistent = true;
+
+    // words holding new letters
+    for (wIt = m_touched.begin(); consistent && (wIt != m_touched.end()); ++wIt) {
+        const uint32_t wi = *wIt;
+        Word* const w = m_model->getWord(wi);
+
+        // a completed word may only miss the dictionary because it's
+        // already in use
+        if (!w->doMatchUpdating()) {
+            *crucio_vout << "\tword " << *w->getDefinition() <<
+                         (w->isComplete() ? ": duplicated (UNIQUE)" : ": no matchings") << endl;
+            consistent = false;
+            break;
+        }
+        if (!w->isComplete()) {
+            continue;
+        }
+
+        // a deterministic solver must be able to tell completed words apart
+        if (isDeterministic() && !isDistinguishable(wi)) {
+            *crucio_vout << "\tword " << *w->getDefinition() <<
+                         ": indistinguishable (DETERMINISTIC)" << endl;
+            consistent = false;
+            break;
+        }
+
+        // completed word, excluded from same length words
+        if (isUnique()) {
+
+            *crucio_vout << "completed word " <<
+                         *w->getDefinition() << ": " << w->get() << "" << endl;
+
+            uint32_t excludedID = w->getID();
+            bool custom = false;
+            if (excludedID == UINT_MAX) {
+                excludedID = w->addCustomID();
+                custom = true;
+                if (excludedID == UINT_MAX) {
+                    continue;
+                }
+            }
+            w->exclude(excludedID);
+            m_exclusions.push_back(Exclusion(wi, excludedID, custom));
+
+            const PackedRange<uint32_t> subset = m_model->getWordsByLength(w->getLength());
+            rematch.insert(subset.begin(), subset.end());
+        }
+    }
+
+    // same length words under new exclusions
+    for (wIt = rematch.begin(); consistent && (wIt != rematch.end()); ++wIt) {
+        Word* const slw = m_model->getWord(*wIt);
+
+        // completed words keep their matchings, unconstrained ones
+        // always match the whole subdictionary
+        if (slw->isComplete() || (slw->getWildcards() == slw->getLength())) {
+            continue;
+        }
+        if (!slw->doMatchUpdating()) {
+            *crucio_vout << "\tword " << *slw->getDefinition() <<
+                         ": no matchings (UNIQUE)" << endl;
+            consistent = false;
+        }
+        m_touched.insert(*wIt);
+    }
+
+    // crossing letters must keep a value
+    for (wIt = m_touched.begin(); consistent && (wIt != m_touched.end()); ++wIt) {
+        const PackedRange<uint32_t> wordLetters = m_model->getWordLetters(*wIt);
+        PackedRange<uint32_t>::const_iterator lIt;
+        for (lIt = wordLetters.begin(); lIt != wordLetters.end(); ++lIt) {
+            if ((m_model->getLetter(*lIt)->get() == ANY_CHAR) &&
+                    getLetterDomain(*lIt).none()) {
+                *crucio_vout << "\tFC failed at " << *lIt << endl;
+                consistent = false;
+                break;
+            }
+        }
+    }
+
+    m_touched.clear();
+    return consistent;
+}
+
+// restores letters and exclusions as they were at marks
+void HybridCompiler::undo(const uint32_t trailMark,
+                          const uint32_t exclusionsMark)
+{
+    set<uint32_t> rematch;
+
+    // readmits words while their letters are still there
+    while (m_exclusions.size() > exclusionsMark) {
+        const Exclusion& x = m_exclusions.back();
+        Word* const w = m_model->getWord(x.m_wi);
+
+        w->include(x.m_id);
+        if (x.m_custom) {
+            w->removeCustomID();
+        }
+
+        const PackedRange<uint32_t> subset = m_model->getWordsByLength(w->getLength());
+        rematch.insert(subset.begin(), subset.end());
+        m_exclusions.pop_back();
+    }
+
+    // retires letters
+    while (m_trail.size() > trailMark) {
+        const uint32_t li = m_trail.back();
+
+        const PackedRange<LetterPosition> letterWords = m_model->getLetterWords(li);
+        PackedRange<LetterPosition>::const_iterator lpIt;
+        for (lpIt = letterWords.begin(); lpIt != letterWords.end(); ++lpIt) {
+            const uint32_t wi = lpIt->getWordIndex();
+            m_model->getWord(wi)->unsetAt(lpIt->getPosition());
+            rematch.insert(wi);
+        }
+
+        m_model->getLetter(li)->unset();
+        ++m_unassigned;
+        m_trail.pop_back();
+    }
+
+    // matchings back to previous patterns, mostly cached
+    set<uint32_t>::const_iterator wIt;
+    for (wIt = rematch.begin(); wIt != rematch.end(); ++wIt) {
+        m_model->getWord(*wIt)->doMatchUpdating();
+    }
+    m_touched.clear();
+}
@@ -0,0 +1,87 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __HYBRID_COMPILER_H
+#define __HYBRID_COMPILER_H
+
+#include <set>
+#include <vector>
+
+#include "common.h"
+#include "Compiler.h"
+
+namespace crucio
+{
+    // branches on the cheapest variable at each step: a whole word when
+    // its matchings fall under a threshold, otherwise the letter having
+    // the smallest domain; words patterns are the only state, domains
+    // are read from matchings and every choice lands on one letters trail
+    class HybridCompiler : public Compiler
+    {
+    public:
+        static const uint32_t DEFAULT_WORD_THRESHOLD = 16;
+
+        HybridCompiler();
+
+        // max matchings for a word to be branched on as a whole
+        void setWordThreshold(const uint32_t threshold) {
+            m_wordThreshold = threshold;
+        }
+        uint32_t getWordThreshold() const {
+            return m_wordThreshold;
+        }
+
+    protected:
+        virtual Compiler::Result configure(const Walk& walk);
+        virtual void reset();
+        virtual Compiler::Result compileFrom(const uint32_t i);
+
+    private:
+
+        // word completed and excluded from same length words (--unique)
+        class Exclusion
+        {
+        public:
+            Exclusion(const uint32_t wi, const uint32_t id, const bool custom) :
+                m_wi(wi),
+                m_id(id),
+                m_custom(custom) {
+            }
+
+            uint32_t m_wi;
+            uint32_t m_id;
+            bool m_custom;
+        };
+
+        uint32_t m_wordThreshold;
+
+        // walk order ranks, break ties
+        std::vector<uint32_t> m_lettersRanks;
+        std::vector<uint32_t> m_wordsRanks;
+
+        // assigned letters and exclusions, undone by marks
+        std::vector<uint32_t> m_trail;
+        std::vector<Exclusion> m_exclusions;
+        uint32_t m_unassigned;
+
+        // words to rematch
+        std::set<uint32_t> m_touched;
+
+        // depending on model alphabet
+        const SymbolTable* m_symbols;
+
+        // branching
+        Compiler::Result branchLetter(const uint32_t li, ABMask domainMask,
+                                      const uint32_t i);
+        Compiler::Result branchWord(const uint32_t wi, const uint32_t i);
+
+        // subproblems
+        void place(const uint32_t li, const char v);
+        bool propagate();
+        void undo(const uint32_t trailMark, const uint32_t exclusionsMark);
+    };
+}
+
+#endif
@@ -0,0 +1,108 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __ID_BITMAP_H
+#define __ID_BITMAP_H
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+#include "common.h"
+
+namespace crucio
+{
+    // growable set of word IDs, one bit per ID
+    class IDBitmap
+    {
+    public:
+        IDBitmap() :
+            m_blocks(),
+            m_count(0),
+            m_signature(0) {
+        }
+
+        bool test(const uint32_t id) const {
+            const uint32_t bi = id >> 6;
+            return ((bi < m_blocks.size()) && ((m_blocks[bi] >> (id & 63)) & 1));
+        }
+        void set(const uint32_t id) {
+            const uint32_t bi = id >> 6;
+            if (bi >= m_blocks.size()) {
+                m_blocks.resize(bi + 1, 0);
+            }
+            const uint64_t bit = ((uint64_t) 1) << (id & 63);
+            if (!(m_blocks[bi] & bit)) {
+                m_blocks[bi] |= bit;
+                ++m_count;
+                m_signature ^= mix(id);
+            }
+        }
+        void reset(const uint32_t id) {
+            const uint32_t bi = id >> 6;
+            if (bi >= m_blocks.size()) {
+                return;
+            }
+            const uint64_t bit = ((uint64_t) 1) << (id & 63);
+            if (m_blocks[bi] & bit) {
+                m_blocks[bi] &= ~bit;
+                --m_count;
+                m_signature ^= mix(id);
+            }
+        }
+        void clear() {
+            std::fill(m_blocks.begin(), m_blocks.end(), 0);
+            m_count = 0;
+            m_signature = 0;
+        }
+
+        uint32_t count() const {
+            return m_count;
+        }
+        bool none() const {
+            return (m_count == 0);
+        }
+
+        // order independent hash of the set IDs, equal sets share it
+        // so it may key results depending on exclusions
+        uint64_t getSignature() const {
+            return m_signature;
+        }
+
+        // lowest ID >= from, UINT_MAX if none
+        uint32_t getNext(const uint32_t from) const {
+            uint32_t bi = from >> 6;
+            if (bi >= m_blocks.size()) {
+                return UINT_MAX;
+            }
+
+            // masks out IDs below from in the first block
+            uint64_t block = m_blocks[bi] & (~((uint64_t) 0) << (from & 63));
+            while (!block) {
+                if (++bi == m_blocks.size()) {
+                    return UINT_MAX;
+                }
+                block = m_blocks[bi];
+            }
+            return ((bi << 6) + firstBit(block));
+        }
+
+    private:
+        std::vector<uint64_t> m_blocks;
+        uint32_t m_count;
+        uint64_t m_signature;
+
+        // scatters an ID over 64 bits (splitmix64 finalizer, constants
+        // split in halves since C++98 lacks 64 bits literals)
+        static uint64_t mix(const uint32_t id) {
+            uint64_t h = id + ((((uint64_t) 0x9E3779B9) << 32) | 0x7F4A7C15);
+            h = (h ^ (h >> 30)) * ((((uint64_t) 0xBF58476D) << 32) | 0x1CE4E5B9);
+            h = (h ^ (h >> 27)) * ((((uint64_t) 0x94D049BB) << 32) | 0x133111EB);
+            return (h ^ (h >> 31));
+        }
+    };
+}
+
+#endif
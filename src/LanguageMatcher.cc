@@ -3,75 +3,98 @@
 // License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
 //
 
+#include "Budget.h"
 #include "LanguageMatcher.h"
+#include "Parallel.h"
 #include "Word.h"
 
 using namespace crucio;
 using namespace std;
 
-// checks for a word to be only-ASCII and in [MIN_LENGTH, MAX_LENGTH]
-bool LanguageMatcher::isValidWord(const string& word)
+// checks for a word to be at least MIN_LENGTH long and made of alphabet
+// symbols only (or their variants, replaced in place)
+bool LanguageMatcher::isValidWord(string* const word) const
 {
-    if ((word.length() < Dictionary::MIN_LENGTH) ||
-            (word.length() > Dictionary::MAX_LENGTH)) {
-
+    if (word->length() < Dictionary::MIN_LENGTH) {
         return false;
     }
 
-    // true if no non-ASCII letters, that is (IsNotAscii() == false)
-    // for each letter in the word
-    return (find_if(word.begin(), word.end(), IsNotAscii()) == word.end());
+    return m_symbols->normalize(word);
 }
 
 LanguageMatcher::LanguageMatcher(const set<string>* const words) :
     m_words(words),
-    m_filename()
+    m_filename(),
+    m_symbols(NULL),
+    m_filter(NULL),
+    m_cache()
 {
     assert(words != NULL);
 }
 
 LanguageMatcher::LanguageMatcher(const string& filename) :
     m_words(NULL),
-    m_filename(filename)
+    m_filename(filename),
+    m_symbols(NULL),
+    m_filter(NULL),
+    m_cache()
 {
     assert(!filename.empty());
 }
 
+LanguageMatcher::LanguageMatcher() :
+    m_words(NULL),
+    m_filename(),
+    m_symbols(NULL),
+    m_filter(NULL),
+    m_cache()
+{
+}
+
 LanguageMatcher::~LanguageMatcher()
 {
 }
 
 void LanguageMatcher::loadIndex(WordSetIndex* const wsIndex)
 {
+    // save alphabet locally, cached results refer to previous index
+    m_symbols = &wsIndex->getSymbols();
+    m_cache.clear();
+
     if (m_words) {
         loadWords(wsIndex);
     } else {
         loadFilename(wsIndex);
     }
+}
 
-    // save alphabet locally
-    m_alphabet = wsIndex->getAlphabet();
+void LanguageMatcher::resetIndex(WordSetIndex* const wsIndex)
+{
+    // same alphabet, cached results refer to previous index
+    m_symbols = &wsIndex->getSymbols();
+    m_cache.clear();
 }
 
-void LanguageMatcher::loadWords(WordSetIndex* const wsIndex) const
+void LanguageMatcher::setFilter(const WordFilter* const filter)
 {
-    // uppercase
-    MakeUpper upper;
+    // cached results were unfiltered
+    m_filter = filter;
+    m_cache.clear();
+}
 
+void LanguageMatcher::loadWords(WordSetIndex* const wsIndex) const
+{
 #ifdef CRUCIO_C_ARRAYS
     map<uint32_t, vector<string> > wordsets;
 
     // loads words into vector (a word each line)
     set<string>::const_iterator wIt;
     for (wIt = m_words->begin(); wIt != m_words->end(); ++wIt) {
-        const string& word = *wIt;
+        // makes a normalized copy
+        string upperWord = *wIt;
 
         // checks word's length and format
-        if (isValidWord(word)) {
-
-            // makes an uppercase copy
-            string upperWord = word;
-            for_each(upperWord.begin(), upperWord.end(), upper);
+        if (isValidWord(&upperWord)) {
 
             // put into same length set (create if non-existing)
             const size_t len = upperWord.length();
@@ -88,13 +111,13 @@ void LanguageMatcher::loadWords(WordSetIndex* const wsIndex) const
         const uint32_t length = refSet->first;
         vector<string>& subwords = refSet->second;
 
-        // never count on an already sorted-and-unique word list (in order to do binary search)
-        sort(subwords.begin(), subwords.end());
-        unique(subwords.begin(), subwords.end());
+        // IDs in load order, by score and alphabetically
+        vector<uint32_t> scores;
+        orderWords(&subwords, &scores);
 
         // load into word set
-        WordSet *ws = wsIndex->getWordSet(length);
-        ws->load(subwords);
+        WordSet *ws = wsIndex->createWordSet(length);
+        ws->load(subwords, scores);
 
 //        cout << "length " << length << " = " << subwords.size() << " words (" << ws->getSize() << " loaded)" << endl;
     }
@@ -102,107 +125,213 @@ void LanguageMatcher::loadWords(WordSetIndex* const wsIndex) const
     // loads words
     set<string>::const_iterator wIt;
     for (wIt = words.begin(); wIt != words.end(); ++wIt) {
-        const string& word = *wIt;
+        // makes a normalized copy
+        string upperWord = *wIt;
 
         // checks word's length and format
-        if (isValidWord(word)) {
-
-            // makes an uppercase copy
-            string upperWord = word;
-            for_each(upperWord.begin(), upperWord.end(), upper);
+        if (isValidWord(&upperWord)) {
 
             // selects wordset for insertion
-            WordSet* const ws = m_index->getWordSet(upperWord.length());
+            WordSet* const ws = m_index->createWordSet(upperWord.length());
             ws->insert(upperWord);
         }
     }
 #endif
 }
 
-void LanguageMatcher::loadFilename(WordSetIndex* const wsIndex) const
+// same length words and their scores, in parallel
+class WordBucket
 {
-    // opens words list file
-    ifstream wordsIn(m_filename.c_str());
-    if (!wordsIn.is_open()) {
-        throw DictionaryException("dictionary: unable to open words list");
+public:
+    WordBucket() :
+        m_words(),
+        m_scores() {
+    }
+
+    void push(const string& word, const uint32_t score) {
+        m_words.push_back(word);
+        m_scores.push_back(score);
+    }
+    void append(WordBucket* const bucket) {
+        if (m_words.empty()) {
+            m_words.swap(bucket->m_words);
+            m_scores.swap(bucket->m_scores);
+        } else {
+            m_words.insert(m_words.end(), bucket->m_words.begin(), bucket->m_words.end());
+            m_scores.insert(m_scores.end(), bucket->m_scores.begin(), bucket->m_scores.end());
+        }
+    }
+
+    vector<string> m_words;
+    vector<uint32_t> m_scores;
+};
+
+// state shared by file loading jobs
+class LanguageMatcher::FileLoad
+{
+public:
+    static const size_t MIN_CHUNK_SIZE = 1 << 16;
+
+    explicit FileLoad(const LanguageMatcher* const matcher) :
+        m_matcher(matcher),
+        m_buffer(),
+        m_chunksOffsets(),
+        m_chunksWords(),
+        m_wordSets(),
+        m_sources(),
+        m_targets(),
+        m_presorted(),
+        m_chunksInvalid() {
     }
 
-    // uppercase
-    MakeUpper upper;
+    const LanguageMatcher* const m_matcher;
 
-//    const time_t timeBegin = time(NULL);
+    // file contents, split at m_chunksOffsets
+    std::vector<char> m_buffer;
+    std::vector<size_t> m_chunksOffsets;
 
-#ifdef CRUCIO_C_ARRAYS
-    map<uint32_t, size_t> wordCount;
-    map<uint32_t, vector<string>* > wordSets;
+    // valid words by length, per chunk and then joined
+    std::vector<std::map<uint32_t, WordBucket> > m_chunksWords;
+    std::map<uint32_t, WordBucket> m_wordSets;
+
+    // a job per length
+    std::vector<WordBucket*> m_sources;
+    std::vector<WordSet*> m_targets;
+
+    // word sets that skipped sorting
+    std::vector<char> m_presorted;
+
+    // chunks with malformed scores
+    std::vector<char> m_chunksInvalid;
+};
+
+const size_t LanguageMatcher::FileLoad::MIN_CHUNK_SIZE;
+
+// a word each line, as getline() would read them, optionally followed
+// by ';' and its score
+void LanguageMatcher::splitChunk(const uint32_t i, void* const context)
+{
+    FileLoad* const load = (FileLoad*) context;
+    const char* const buffer = (load->m_buffer.empty() ? NULL : &load->m_buffer[0]);
+    const size_t end = load->m_chunksOffsets[i + 1];
+    map<uint32_t, WordBucket>& wordSets = load->m_chunksWords[i];
     string word;
 
-    // count words by length
-    while (getline(wordsIn, word)) {
+    size_t begin = load->m_chunksOffsets[i];
+    while (begin < end) {
+        const char* const newline =
+            (const char*) memchr(buffer + begin, '\n', end - begin);
+        const size_t last = (newline ? (size_t)(newline - buffer) : end);
+
+        // score digits, DEFAULT_SCORE if none
+        const char* const separator =
+            (const char*) memchr(buffer + begin, ';', last - begin);
+        const size_t wordLast = (separator ? (size_t)(separator - buffer) : last);
+        uint32_t score = DEFAULT_SCORE;
+        if (separator && !parseScore(separator + 1, buffer + last, &score)) {
+            load->m_chunksInvalid[i] = 1;
+            return;
+        }
 
         // checks word's length and format
-        if (isValidWord(word)) {
-            const uint32_t len = (uint32_t)word.length();
-            ++wordCount[len];
+        // IMPORTANT: normalizes to alphabet symbols
+        word.assign(buffer + begin, wordLast - begin);
+        if (load->m_matcher->isValidWord(&word)) {
+            wordSets[(uint32_t)word.length()].push(word, score);
         }
+
+        begin = last + 1;
     }
+}
 
-//    cout << "non-empty lenghts = " << wordCount.size() << endl;
-//    map<uint32_t, size_t>::const_iterator wcIt;
-//    for (wcIt = wordCount.begin(); wcIt != wordCount.end(); ++wcIt) {
-//        cout << "predicted count for length " << wcIt->first << " = " << wcIt->second << " words" << endl;
-//    }
+void LanguageMatcher::loadWordSet(const uint32_t i, void* const context)
+{
+    FileLoad* const load = (FileLoad*) context;
+    WordBucket& bucket = *load->m_sources[i];
 
-    // reset file pointer
-    wordsIn.clear();
-    wordsIn.seekg(0, ios::beg);
+    // IDs in load order, by score and alphabetically
+    load->m_presorted[i] = orderWords(&bucket.m_words, &bucket.m_scores);
 
-    // loads words into vector (a word each line)
-    while (getline(wordsIn, word)) {
+    // load into word set
+    load->m_targets[i]->load(bucket.m_words, bucket.m_scores);
 
-        // checks word's length and format
-        if (isValidWord(word)) {
+    // release temporary vectors immediately afterwards
+    vector<string>().swap(bucket.m_words);
+    vector<uint32_t>().swap(bucket.m_scores);
+}
 
-            // IMPORTANT: make uppercase
-            for_each(word.begin(), word.end(), upper);
+void LanguageMatcher::loadFilename(WordSetIndex* const wsIndex) const
+{
+    // opens words list file
+    ifstream wordsIn(m_filename.c_str());
+    if (!wordsIn.is_open()) {
+        throw DictionaryException("dictionary: unable to open words list");
+    }
 
-            // put into same length set (create if non-existing)
-            const uint32_t len = (uint32_t)word.length();
-            map<uint32_t, vector<string>* >::iterator refSet = wordSets.find(len);
-            if (refSet == wordSets.end()) {
-                vector<string>* subwords = new vector<string>();
-                subwords->reserve(wordCount[len]);
+#ifdef CRUCIO_C_ARRAYS
+    const uint64_t beginMillis = Budget::nowMillis();
+    FileLoad load(this);
 
-                refSet = wordSets.insert(make_pair(len, subwords)).first;
-            }
-            refSet->second->push_back(word);
-        }
+    // whole file in a single read
+    wordsIn.seekg(0, ios::end);
+    const streamoff size = wordsIn.tellg();
+    wordsIn.seekg(0, ios::beg);
+    load.m_buffer.resize((size_t) size);
+    if (size > 0) {
+        wordsIn.read(&load.m_buffer[0], size);
     }
 
     // closes file
     wordsIn.close();
 
-    // load word sets
-    map<uint32_t, vector<string>* >::iterator refSet;
-    for (refSet = wordSets.begin(); refSet != wordSets.end(); ++refSet) {
-        const uint32_t len = refSet->first;
-        vector<string>* subwords = refSet->second;
-
-        // never count on an already sorted-and-unique word list (in order to do binary search)
-        sort(subwords->begin(), subwords->end());
-        unique(subwords->begin(), subwords->end());
+    // a few chunks per thread, ending on line boundaries
+    const size_t chunksNum = max((size_t) 1,
+                                 min((size_t) getParallelThreads() * 4,
+                                     load.m_buffer.size() / FileLoad::MIN_CHUNK_SIZE));
+    load.m_chunksOffsets.push_back(0);
+    for (size_t ci = 1; ci < chunksNum; ++ci) {
+        size_t offset = max(load.m_chunksOffsets.back(),
+                            ci * load.m_buffer.size() / chunksNum);
+        while ((offset < load.m_buffer.size()) && (load.m_buffer[offset - 1] != '\n')) {
+            ++offset;
+        }
+        load.m_chunksOffsets.push_back(offset);
+    }
+    load.m_chunksOffsets.push_back(load.m_buffer.size());
+    load.m_chunksWords.resize(chunksNum);
+    load.m_chunksInvalid.resize(chunksNum, 0);
+
+    // validates and buckets by length
+    runParallel((uint32_t)chunksNum, splitChunk, &load);
+    vector<char>().swap(load.m_buffer);
+    if (count(load.m_chunksInvalid.begin(), load.m_chunksInvalid.end(), 1) > 0) {
+        throw DictionaryException("dictionary: invalid word score in words list");
+    }
 
-        // load into word set
-        WordSet *ws = wsIndex->getWordSet(len);
-        ws->load(*subwords);
+    // joins buckets in file order, word sets are created serially
+    vector<map<uint32_t, WordBucket> >::iterator cwIt;
+    for (cwIt = load.m_chunksWords.begin(); cwIt != load.m_chunksWords.end(); ++cwIt) {
+        map<uint32_t, WordBucket>::iterator bIt;
+        for (bIt = cwIt->begin(); bIt != cwIt->end(); ++bIt) {
+            load.m_wordSets[bIt->first].append(&bIt->second);
+        }
+        cwIt->clear();
+    }
+    map<uint32_t, WordBucket>::iterator refSet;
+    for (refSet = load.m_wordSets.begin(); refSet != load.m_wordSets.end(); ++refSet) {
+        load.m_sources.push_back(&refSet->second);
+        load.m_targets.push_back(wsIndex->createWordSet(refSet->first));
+    }
 
-//        cout << "length " << len << " = " << subwords->size() << " words (" << ws->getSize() << " loaded)" << endl;
+    // sorts and loads different lengths concurrently
+    load.m_presorted.resize(load.m_sources.size(), 0);
+    runParallel((uint32_t)load.m_sources.size(), loadWordSet, &load);
 
-        // release temporary vector immediately afterwards
-        // reduces overall memory usage, there's no need to
-        // keep all of them in memory at the same time
-        delete subwords;
-    }
+    // startup cost, sorting is skipped for presorted lengths
+    *crucio_vout << "dictionary loaded in " <<
+                 (Budget::nowMillis() - beginMillis) << " ms (" <<
+                 count(load.m_presorted.begin(), load.m_presorted.end(), 1) <<
+                 "/" << load.m_presorted.size() << " lengths presorted)" << endl;
 #else
     vector<string> sortedWords;
     string word;
@@ -219,14 +348,12 @@ void LanguageMatcher::loadFilename(WordSetIndex* const wsIndex) const
     while (getline(wordsIn, word)) {
 
         // checks word's length and format
-        if (isValidWord(word)) {
-
-            // IMPORTANT: make uppercase
-            for_each(word.begin(), word.end(), upper);
+        // IMPORTANT: normalizes to alphabet symbols
+        if (isValidWord(&word)) {
 
 #ifdef CRUCIO_BENCHMARK
             // loads word directly (assume word list is sorted and unique)
-            WordSet* const ws = m_index->getWordSet(word.length());
+            WordSet* const ws = m_index->createWordSet(word.length());
             ws->insert(word);
 #else
             // adds word to vector
@@ -239,9 +366,9 @@ void LanguageMatcher::loadFilename(WordSetIndex* const wsIndex) const
     wordsIn.close();
 
 #ifndef CRUCIO_BENCHMARK
-    // never count on an already sorted-and-unique word list (in order to do binary search)
-    sort(sortedWords.begin(), sortedWords.end());
-    unique(sortedWords.begin(), sortedWords.end());
+    // binary search needs a sorted-and-unique word list
+    vector<uint32_t> scores;
+    orderWords(&sortedWords, &scores);
 
     // adds filtered words
     vector<string>::const_iterator wIt;
@@ -249,45 +376,85 @@ void LanguageMatcher::loadFilename(WordSetIndex* const wsIndex) const
         const string& word = *wIt;
 
         // selects wordset for insertion
-        WordSet* const ws = m_index->getWordSet(word.length());
+        WordSet* const ws = m_index->createWordSet(word.length());
         ws->insert(word);
     }
 #endif
 #endif
-
-//    const time_t timeEnd = time(NULL);
-//    const double timeElapsed = difftime(timeEnd, timeBegin);
-//    cout << "dictionary loaded in " << timeElapsed << " seconds" << endl;
 }
 
+// collects matching IDs into a result
+class LanguageMatcher::ResultSink
+{
+public:
+    explicit ResultSink(MatchingResult* const res) :
+        m_res(res) {
+    }
+
+    // false stops the scan
+    bool add(const uint32_t id) {
+        m_res->addID(id);
+        return true;
+    }
+
+private:
+    MatchingResult* const m_res;
+};
+
+// counts matching IDs up to a limit
+class LanguageMatcher::CountSink
+{
+public:
+    explicit CountSink(const uint32_t limit) :
+        m_limit(limit),
+        m_count(0) {
+    }
+
+    // false stops the scan
+    bool add(const uint32_t) {
+        return (++m_count < m_limit);
+    }
+
+    uint32_t getCount() const {
+        return m_count;
+    }
+
+private:
+    const uint32_t m_limit;
+    uint32_t m_count;
+};
+
 bool LanguageMatcher::getMatchings(WordSetIndex* const wsIndex,
                                    Word* const word)
 {
     const string& pattern = word->get();
     MatchingResult* const res = word->getMatchings();
-    const set<uint32_t>& exclusions = word->getExclusions();
+    const IDBitmap& exclusions = word->getExclusions();
 
     const uint32_t len = (uint32_t)pattern.length();
 
     // initially empty result
     res->clear();
 
-    // single letters matching
+    // no words of this length
     const WordSet* const ws = wsIndex->getWordSet(len);
-#ifdef CRUCIO_C_ARRAYS
-    list<const IDArray* > cpVectors;
-#else
-    list<const vector<uint32_t>* > cpVectors;
-#endif
-    for (uint32_t pi = 0; pi < len; ++pi) {
-        if (pattern[pi] != ANY_CHAR) {
-            cpVectors.push_back(ws->getCPVector(pi, pattern[pi]));
-        }
+    if (!ws) {
+        return false;
+    }
+
+    // the same pattern under the same exclusions was already matched;
+    // wild patterns ignore exclusions
+    const bool wild = isWild(pattern);
+    const uint64_t signature = (wild ? 0 : exclusions.getSignature());
+    IDBuffer* const cached = m_cache.find(pattern, signature);
+    if (cached) {
+        res->share(cached);
+        return !res->isEmpty();
     }
 
     // wild pattern, that is an ANY_CHAR-only pattern; this maps to whole
     // subdictionary
-    if (cpVectors.empty()) {
+    if (wild) {
 
         // IMPORTANT: very expensive, but only happens at model creation; this
         // is because compiler classes only call Word::doMatch() after
@@ -295,60 +462,147 @@ bool LanguageMatcher::getMatchings(WordSetIndex* const wsIndex,
         // masks are _never_ re-matched, apart at model creation time when
         // initial domains have to be evaluated
         const uint32_t wsSize = ws->getSize();
+        if (m_filter) {
+            const IDBitmap& allowed = m_filter->getAllowed(len);
+            res->reserve(allowed.count());
+            for (uint32_t id = allowed.getNext(0); id < wsSize; id = allowed.getNext(id + 1)) {
+                res->addID(id);
+            }
+            m_cache.insert(pattern, signature, res);
+            return !res->isEmpty();
+        }
         res->reserve(wsSize);
         for (uint32_t id = 0; id < wsSize; ++id) {
             res->addID(id);
         }
+        m_cache.insert(pattern, signature, res);
         return true;
     }
 
-    // intersects matchings; set intersection is at most large as smallest set,
-    // so other sets are filtered on this one; smallest set search cost is a
-    // good tradeoff for subsequent computation
+    ResultSink sink(res);
+    intersect(ws, pattern, exclusions, &sink);
+
+    m_cache.insert(pattern, signature, res);
+
+    // true if intersection is not empty
+    return !res->getIDs().empty();
+}
+
+uint32_t LanguageMatcher::countMatchings(WordSetIndex* const wsIndex,
+                                         const Word* const word,
+                                         const uint32_t limit)
+{
+    const string& pattern = word->get();
+    const IDBitmap& exclusions = word->getExclusions();
+
+    // no words of this length
+    const WordSet* const ws = wsIndex->getWordSet((uint32_t)pattern.length());
+    if (!ws || (limit == 0)) {
+        return 0;
+    }
+
+    // cached matchings are already counted
+    const bool wild = isWild(pattern);
+    const IDBuffer* const cached =
+        m_cache.find(pattern, (wild ? 0 : exclusions.getSignature()));
+    if (cached) {
+        return min((uint32_t)cached->getIDs().size(), limit);
+    }
+
+    // whole subdictionary
+    if (wild) {
+        if (m_filter) {
+            return min(m_filter->getAllowedNum((uint32_t)pattern.length()), limit);
+        }
+        return min(ws->getSize(), limit);
+    }
+
+    CountSink sink(limit);
+    intersect(ws, pattern, exclusions, &sink);
+    return sink.getCount();
+}
+
+// true if pattern has no letters
+bool LanguageMatcher::isWild(const string& pattern)
+{
+    return (pattern.find_first_not_of(ANY_CHAR) == string::npos);
+}
+
+// feeds sink with the non excluded IDs matching a non-wild pattern, in
+// ascending order, until sink refuses more
+template<typename Sink>
+void LanguageMatcher::intersect(const WordSet* const ws,
+                                const string& pattern,
+                                const IDBitmap& exclusions,
+                                Sink* const sink) const
+{
+    const uint32_t len = (uint32_t)pattern.length();
+
+    // view restriction
+    const IDBitmap* const allowed = (m_filter ? &m_filter->getAllowed(len) : NULL);
+
+    // single letters matching; intersection is at most large as smallest
+    // set, so other letters are filtered on this one
 #ifdef CRUCIO_C_ARRAYS
-    list<const IDArray*>::const_iterator minSetIt;
-    minSetIt = min_element(cpVectors.begin(), cpVectors.end(), MinSizePtr());
-    const IDArray* const minSet = *minSetIt;
+    const IDArray* minSet = NULL;
+    uint32_t minPos = 0;
+    for (uint32_t pi = 0; pi < len; ++pi) {
+        if (pattern[pi] != ANY_CHAR) {
+            const IDArray* const cpVector = ws->getCPVector(pi, pattern[pi]);
+            if (!minSet || (cpVector->length < minSet->length)) {
+                minSet = cpVector;
+                minPos = pi;
+            }
+        }
+    }
+
+    // remaining letters are checked on WordSet columns, a byte lookup
+    // per letter instead of a binary search in their sets
+    vector<pair<const unsigned char*, unsigned char> > columns;
+    columns.reserve(len);
+    for (uint32_t pi = 0; pi < len; ++pi) {
+        if ((pattern[pi] != ANY_CHAR) && (pi != minPos)) {
+            const unsigned char chIndex = (unsigned char) m_symbols->getIndex(pattern[pi]);
+            columns.push_back(make_pair(ws->getColumn(pi), chIndex));
+        }
+    }
+    const uint32_t checks = (uint32_t)columns.size();
 
     // iterates over minSet and search for its elements in the other sets
-    uint32_t idi;
-    list<const IDArray*>::const_iterator setIt;
+    uint32_t idi, ci;
     for (idi = 0; idi < minSet->length; ++idi) {
         const uint32_t id = minSet->ids[idi];
 
-        // skips excluded elements (if given)
-        if (exclusions.find(id) != exclusions.end()) {
+        // skips excluded elements (if given) and those out of view
+        if (exclusions.test(id) || (allowed && !allowed->test(id))) {
             continue;
         }
 
-        // element must be found in every set
+        // element must match every other letter
         bool foundAll = true;
-        for (setIt = cpVectors.begin(); setIt != cpVectors.end(); ++setIt) {
-
-            // skips minSet
-            if (setIt == minSetIt) {
-                continue;
-            }
-
-            const IDArray* const currSet = *setIt;
-
-            // searches the element in this set (set is sorted since
-            // WordSet::insert() assigns ascending IDs, so binary
-            // search is MUCH better)
-            //if (find(currSet->begin(), currSet->end(), id) ==
-            //      currSet->end()) {
-            if (!binary_search(currSet->ids, currSet->ids + currSet->length, id)) {
+        for (ci = 0; ci < checks; ++ci) {
+            if (columns[ci].first[id] != columns[ci].second) {
                 foundAll = false;
                 break;
             }
         }
 
         // if found in every set, element is added to intersection
-        if (foundAll) {
-            res->addID(id);
+        if (foundAll && !sink->add(id)) {
+            return;
         }
     }
 #else
+    list<const vector<uint32_t>* > cpVectors;
+    for (uint32_t pi = 0; pi < len; ++pi) {
+        if (pattern[pi] != ANY_CHAR) {
+            cpVectors.push_back(ws->getCPVector(pi, pattern[pi]));
+        }
+    }
+
+    // intersects matchings; set intersection is at most large as smallest set,
+    // so other sets are filtered on this one; smallest set search cost is a
+    // good tradeoff for subsequent computation
     list<const vector<uint32_t>* >::const_iterator minSetIt;
     minSetIt = min_element(cpVectors.begin(), cpVectors.end(), MinSizePtr());
     const vector<uint32_t>* const minSet = *minSetIt;
@@ -359,9 +613,8 @@ bool LanguageMatcher::getMatchings(WordSetIndex* const wsIndex,
     for (idIt = minSet->begin(); idIt != minSet->end(); ++idIt) {
         const uint32_t id = *idIt;
 
-        // skips excluded elements (if given)
-//        if (excluded && (excluded->find(id) != excluded->end())) {
-        if ((excluded->find(id) != excluded->end())) {
+        // skips excluded elements (if given) and those out of view
+        if (exclusions.test(id) || (allowed && !allowed->test(id))) {
             continue;
         }
 
@@ -388,14 +641,11 @@ bool LanguageMatcher::getMatchings(WordSetIndex* const wsIndex,
         }
 
         // if found in every set, element is added to intersection
-        if (foundAll) {
-            res->m_ids.push_back(id);
+        if (foundAll && !sink->add(id)) {
+            return;
         }
     }
 #endif
-
-    // true if intersection is not empty
-    return !res->getIDs().empty();
 }
 
 //bool LanguageMatcher::getPossible(WordSetIndex* const wsIndex,
@@ -443,6 +693,12 @@ bool LanguageMatcher::getMatchings(WordSetIndex* const wsIndex,
 //    return true;
 //}
 
+bool LanguageMatcher::supportsLength(const WordSetIndex* const wsIndex,
+                                     const uint32_t len) const
+{
+    return (wsIndex->getWordSet(len) != NULL);
+}
+
 bool LanguageMatcher::getPossible(WordSetIndex* const wsIndex,
                                   Word* const word)
 {
@@ -466,41 +722,86 @@ bool LanguageMatcher::getPossible(WordSetIndex* const wsIndex,
         return false;
     }
 
+    // masks already computed for these results
+    if (!res->getMasks().empty()) {
+        possibleVector = res->getMasks();
+        return true;
+    }
+
     // current wordset
     const WordSet* const ws = wsIndex->getWordSet(len);
 
-    // are matchings equal to whole subdictionary?
-    if (res->isFull()) {
+    // are matchings equal to whole subdictionary? (a filtered one is
+    // scanned instead)
+    if (res->isFull() && !m_filter) {
         for (pos = 0; pos < len; ++pos) {
             ABMask* const possible = &possibleVector[pos];
             ws->getPossibleAt(pos, possible);
         }
     } else {
+#ifdef CRUCIO_C_ARRAYS
+        const vector<uint32_t>& ids = res->getIDs();
+        const uint32_t* const idsPtr = &ids[0];
+        const uint32_t idsSize = (uint32_t)ids.size();
+
+        // large results likely hit every letter allowed at a position
+        // well before their end, so the scan stops there
+        const bool earlyExit = (idsSize > m_symbols->getSize());
+
+        // gathers letters at every position from WordSet columns
+        for (pos = 0; pos < len; ++pos) {
+            const unsigned char* const column = ws->getColumn(pos);
+
+            ABMask::Bits wholeBits = ~((ABMask::Bits) 0);
+            if (earlyExit) {
+                ABMask whole;
+                ws->getPossibleAt(pos, &whole);
+                wholeBits = whole.bits();
+            }
+
+            // puts letters into letter mask, four words at a time
+            ABMask::Bits bits = 0;
+            uint32_t idi = 0;
+            while ((idi + 4 <= idsSize) && (bits != wholeBits)) {
+                bits |= ((ABMask::Bits) 1) << column[idsPtr[idi]];
+                bits |= ((ABMask::Bits) 1) << column[idsPtr[idi + 1]];
+                bits |= ((ABMask::Bits) 1) << column[idsPtr[idi + 2]];
+                bits |= ((ABMask::Bits) 1) << column[idsPtr[idi + 3]];
+                idi += 4;
+            }
+            if (bits != wholeBits) {
+                for (; idi < idsSize; ++idi) {
+                    bits |= ((ABMask::Bits) 1) << column[idsPtr[idi]];
+                }
+            }
+            possibleVector[pos] = ABMask(bits);
+        }
+#else
 
         // iterates over matching words IDs
         const vector<uint32_t>& ids = res->getIDs();
         vector<uint32_t>::const_iterator idIt;
         for (idIt = ids.begin(); idIt != ids.end(); ++idIt) {
             const uint32_t id = *idIt;
-#ifdef CRUCIO_C_ARRAYS
-            const char* word = ws->getWordPtr(id);
-#else
             const string& word = ws->getWord(id);
-#endif
 
             // finds possible letters at every position
             for (pos = 0; pos < len; ++pos) {
                 ABMask* const possible = &possibleVector[pos];
 
                 // letter index at position pos in the word
-                const uint32_t chIndex = character2Index(m_alphabet, word[pos]);
+                const uint32_t chIndex = m_symbols->getIndex(word[pos]);
 
                 // puts letter into letter mask
                 possible->set(chIndex);
             }
         }
+#endif
     }
 
+    // shared with any other holder of these results
+    res->saveMasks(possibleVector);
+
     return true;
 }
 
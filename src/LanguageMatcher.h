@@ -7,6 +7,8 @@
 #define __LANGUAGE_MATCHER_H
 
 #include "Dictionary.h"
+#include "IDBitmap.h"
+#include "MatchCache.h"
 
 namespace crucio
 {
@@ -16,52 +18,51 @@ namespace crucio
     public:
         LanguageMatcher(const std::set<std::string>* const words);
         LanguageMatcher(const std::string& filename);
+
+        // for dictionary views, matches a shared index and loads nothing
+        LanguageMatcher();
         virtual ~LanguageMatcher();
 
         const std::string& getFilename() const {
             return m_filename;
         }
 
+        // pattern matchings cache
+        const MatchCache& getCache() const {
+            return m_cache;
+        }
+        MatchCache& getCache() {
+            return m_cache;
+        }
+
         virtual void loadIndex(WordSetIndex* const wsIndex);
+        virtual void resetIndex(WordSetIndex* const wsIndex);
+        virtual void setFilter(const WordFilter* const filter);
 
         virtual bool getMatchings(WordSetIndex* const wsIndex,
                                   Word* const word);
 
+        virtual uint32_t countMatchings(WordSetIndex* const wsIndex,
+                                        const Word* const word,
+                                        const uint32_t limit);
+
         virtual bool getPossible(WordSetIndex* const wsIndex,
                                  Word* const word);
 
+        virtual bool supportsLength(const WordSetIndex* const wsIndex,
+                                    const uint32_t len) const;
+
         virtual uint32_t addCustomWord(const std::string& word);
         virtual const std::string& getCustomWord(const uint32_t id) const;
         virtual uint32_t getCustomWordID(const std::string& word) const;
         virtual uint32_t removeCustomWordID(const uint32_t id);
 
     private:
-        class MakeUpper
-        {
-        public:
-            void operator()(char& ch) const {
-                ch &= ~32;
-            }
-        };
+        class ResultSink;
+        class CountSink;
+        class FileLoad;
 
-        class IsNotAscii
-        {
-        public:
-            bool operator()(const char ch) const {
-                const char upperCh = ch & ~32;
-                return ((upperCh < 'A') || (upperCh > 'Z'));
-            }
-        };
-
-#ifdef CRUCIO_C_ARRAYS
-        class MinSizePtr
-        {
-        public:
-            bool operator()(const IDArray* const v1, const IDArray* const v2) const {
-                return (v1->length < v2->length);
-            }
-        };
-#else
+#ifndef CRUCIO_C_ARRAYS
         class MinSizePtr
         {
         public:
@@ -78,14 +79,32 @@ namespace crucio
         const std::string m_filename;
 
         // cached alphabet
-        Alphabet m_alphabet;
+        const SymbolTable* m_symbols;
+
+        // allowed words (view), NULL for all
+        const WordFilter* m_filter;
 
-        // input validation
-        static bool isValidWord(const std::string& word);
+        // results of recent patterns
+        MatchCache m_cache;
+
+        // input validation (normalizes word to alphabet symbols)
+        bool isValidWord(std::string* const word) const;
 
         // subroutines
         void loadWords(WordSetIndex *const wsIndex) const;
         void loadFilename(WordSetIndex *const wsIndex) const;
+
+        // parallel file loading steps (FileLoad context)
+        static void splitChunk(const uint32_t i, void* const context);
+        static void loadWordSet(const uint32_t i, void* const context);
+
+        // pattern scan shared by matching and counting
+        static bool isWild(const std::string& pattern);
+        template<typename Sink>
+        void intersect(const WordSet* const ws,
+                       const std::string& pattern,
+                       const IDBitmap& exclusions,
+                       Sink* const sink) const;
     };
 }
 
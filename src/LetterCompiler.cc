@@ -14,7 +14,9 @@ LetterCompiler::LetterCompiler() :
     m_revOrder(),
     m_deps(),
     m_revDeps(),
-    m_bj()
+    m_bj(),
+    m_allDiff(),
+    m_symbols(NULL)
 {
 }
 
@@ -24,8 +26,7 @@ Compiler::Result LetterCompiler::configure(const Walk& walk)
     uint32_t li;
 
     // prepare alphabet conversions
-    m_alphabet = m_model->getAlphabet();
-    m_alphabetSize = alphabetSize(m_alphabet);
+    m_symbols = &m_model->getSymbols();
 
     // letters count
     const uint32_t lettersNum = m_model->getLettersNum();
@@ -37,6 +38,12 @@ Compiler::Result LetterCompiler::configure(const Walk& walk)
     // letters graph visit
     walk.visitLetters(*m_model, &m_order);
     Walk::getReverseOrder(m_order, &m_revOrder);
+    if (isVerbose()) {
+        vector<vector<uint32_t> > graph;
+        Walk::getLettersGraph(*m_model, &graph);
+        *crucio_vout << "letters order bandwidth = " <<
+                     Walk::getBandwidth(graph, m_order) << endl;
+    }
 
     // direct and reverse dependencies
     for (li = 0; li < lettersNum; ++li) {
@@ -45,9 +52,9 @@ Compiler::Result LetterCompiler::configure(const Walk& walk)
 //        ordLi = m_revOrder[li];
 
         // computes dependencies from related letters
-        const list<pair<uint32_t, LetterPosition> >& neighbours =
+        const PackedRange<pair<uint32_t, LetterPosition> > neighbours =
             m_model->getLetterNeighbours(li);
-        list<pair<uint32_t, LetterPosition> >::const_iterator nbIt;
+        PackedRange<pair<uint32_t, LetterPosition> >::const_iterator nbIt;
         for (nbIt = neighbours.begin(); nbIt != neighbours.end(); ++nbIt) {
             const uint32_t rLi = nbIt->first;
 
@@ -113,6 +120,9 @@ Compiler::Result LetterCompiler::configure(const Walk& walk)
     }
     m_bj.configure(m_order, ordDeps);
 
+    // independent subproblems
+    configureComponents(m_order, m_model->getLettersComponents());
+
     // use letter-based domains
     m_model->computeLetterDomains();
 
@@ -130,7 +140,15 @@ Compiler::Result LetterCompiler::compileFrom(const uint32_t i)
 {
     // all variables instantiated?
     if (i == m_model->getLettersNum()) {
-        return Compiler::SUCCESS;
+
+        // enumeration resumes from here as from a failure
+        if (acceptSolution()) {
+            return Compiler::SUCCESS;
+        }
+#ifdef CRUCIO_BJ
+        m_bj.solution(i);
+#endif
+        return Compiler::FAILURE_IMPOSSIBLE;
     } else {
 
         // maps variable from ordering
@@ -138,7 +156,7 @@ Compiler::Result LetterCompiler::compileFrom(const uint32_t i)
 
         // admittable domain
         ABMask domainMask = m_domains[li];
-        *crucio_vout << "domain for " << li << " = " << ABMaskString(m_alphabet, domainMask) << endl;
+        *crucio_vout << "domain for " << li << " = " << m_symbols->getMaskString(domainMask) << endl;
 
         // removal stack through forward checking
         stack<pair<uint32_t, ABMask> > remStack;
@@ -155,8 +173,13 @@ Compiler::Result LetterCompiler::compileFrom(const uint32_t i)
         // iterates over domain
         while (domainMask.any()) {
 
+            // search limits
+            if (isInterrupted()) {
+                return getInterruption();
+            }
+
             // chooses value to assign
-            const char v = choose(&domainMask);
+            const char v = choose(li, &domainMask);
 
             *crucio_vout << "letter " << li << " = '" << v << "'" << endl;
 
@@ -170,14 +193,24 @@ Compiler::Result LetterCompiler::compileFrom(const uint32_t i)
             printModelGrid(*crucio_vout, *m_model);
             *crucio_vout << endl;
 
+            // deepest partial fill, by assigned letters
+            saveBest(i + 1);
+
             // recursively solved?
-            if (compileFrom(i + 1) == Compiler::SUCCESS) {
+            const Compiler::Result result = compileFrom(i + 1);
+            if (result == Compiler::SUCCESS) {
                 return Compiler::SUCCESS;
             } else {
-                
+
                 // retires variable
                 retire(li, &remStack);
 
+                // interrupted rather than failed, or no way out
+                if ((result != Compiler::FAILURE_IMPOSSIBLE) ||
+                        isComponentFailed()) {
+                    return result;
+                }
+
 #ifdef CRUCIO_BJ
                 // returns if there are no more jumps or last
                 // jump gets past current variable
@@ -188,15 +221,20 @@ Compiler::Result LetterCompiler::compileFrom(const uint32_t i)
                 }
 #endif
             }
-
-            // timeout check
-            if (isTimeout()) {
-                return Compiler::FAILURE_TIMEOUT;
-            }
         }
 
         *crucio_vout << "letter " << li << " ... BACKTRACK!" << endl;
 
+        // backtracks are charged too
+        if (isInterruptedOnBacktrack()) {
+            return getInterruption();
+        }
+
+        // later components can't be fixed from here
+        if (failComponent(i)) {
+            return Compiler::FAILURE_IMPOSSIBLE;
+        }
+
         // algorithm fails iff first variable backtracks
         if (i > 0) {
 #ifdef CRUCIO_BJ
@@ -212,46 +250,23 @@ Compiler::Result LetterCompiler::compileFrom(const uint32_t i)
     }
 }
 
-char LetterCompiler::choose(ABMask* const domainMask)
+char LetterCompiler::choose(const uint32_t li, ABMask* const domainMask)
 {
-    uint32_t vi = 0;
-
 #ifdef CRUCIO_BENCHMARK
     // ordered choice, no randomness
-    while (!(*domainMask)[vi]) {
-        ++vi;
-    }
+    const uint32_t vi = firstBit(domainMask->bits());
 #else
-    // random choice in [A-Z]
-
-    // XXX: bad method for sparse bitmask (used in benchmarks)
-    do {
-        vi = rand() % m_alphabetSize;
-    } while (!(*domainMask)[vi]);
-
-    // better method for sparse bitmask
-    /*  uint32_t active[m_alphabetSize];
-        uint32_t ai = 0;
-        for (vi = 0; vi < m_alphabetSize; ++vi) {
-
-            // saves active bit position
-            if ((*domainMask)[vi]) {
-                active[ai] = vi;
-                ++ai;
-            }
-        }
-
-        // chooses randomly among active bits
-        const uint32_t chosenAi = rand() % ai;
-        vi = active[chosenAi];
-    */
+    // random choice among letters of best scoring words, whose matchings
+    // are scanned when scored (O(1) pick otherwise)
+    const ABMask::Bits bits = getPreferredLetters(li, *domainMask).bits();
+    const uint32_t vi = randomBit(bits, &m_random);
 #endif
 
     // marks vi-th value as visited
     domainMask->reset(vi);
 
     // alphabetic mapping for vi
-    return index2Character(m_alphabet, vi);
+    return m_symbols->getSymbol(vi);
 }
 
 bool LetterCompiler::assign(const uint32_t li,
@@ -266,10 +281,10 @@ bool LetterCompiler::assign(const uint32_t li,
     l->set(v);
 
     // words current letter belongs to
-    const list<LetterPosition>& letterWords = m_model->getLetterWords(li);
+    const PackedRange<LetterPosition> letterWords = m_model->getLetterWords(li);
 
     // puts new value into related words
-    list<LetterPosition>::const_iterator lpIt;
+    PackedRange<LetterPosition>::const_iterator lpIt;
     for (lpIt = letterWords.begin(); lpIt != letterWords.end(); ++lpIt) {
 
         // related word and its length
@@ -281,8 +296,22 @@ bool LetterCompiler::assign(const uint32_t li,
         // sets character v at position pos within word w
         w->setAt(pos, v);
 
-        // recalculates possible letters within the word
-        w->doMatchUpdating();
+        // recalculates possible letters within the word; a completed word
+        // may only miss the dictionary because it's already in use
+        if (!w->doMatchUpdating() && w->isComplete()) {
+            *crucio_vout << "\tword " << *w->getDefinition() <<
+                         ": duplicated (UNIQUE)" << endl;
+
+            return false;
+        }
+
+        // a deterministic solver must be able to tell completed words apart
+        if (isDeterministic() && w->isComplete() && !isDistinguishable(wi)) {
+            *crucio_vout << "\tword " << *w->getDefinition() <<
+                         ": indistinguishable (DETERMINISTIC)" << endl;
+
+            return false;
+        }
 
         // word completed, constrains remaining words having same length
         if (isUnique() && w->isComplete()) {
@@ -299,30 +328,33 @@ bool LetterCompiler::assign(const uint32_t li,
                 }
             }
 
+            // excludes completed word from all words having same length
+            w->exclude(excludedID);
+
             // selects words subset by length
-            const map<uint32_t, set<uint32_t> >& wordsByLength =
-                m_model->getWordsByLength();
-            const set<uint32_t>& subset = wordsByLength.find(wLen)->second;
+            const PackedRange<uint32_t> subset =
+                m_model->getWordsByLength(wLen);
 
-            // updates exclusion lists and recalculates domains
-            set<uint32_t>::const_iterator slWiIt;
+            // recalculates domains
+            PackedRange<uint32_t>::const_iterator slWiIt;
             for (slWiIt = subset.begin(); slWiIt != subset.end(); ++slWiIt) {
                 const uint32_t slWi = *slWiIt;
 
-                // skips current word
-                if (slWi == wi) {
-                    continue;
-                }
-
                 // same length word
                 Word* const slw = m_model->getWord(slWi);
 
-                // excludes completed word and rematches pattern
-                slw->exclude(excludedID);
+                // skips completed words (current included), whose matchings
+                // must survive until retire(), and unconstrained words, that
+                // always match the whole subdictionary
+                if (slw->isComplete() || (slw->getWildcards() == wLen)) {
+                    continue;
+                }
+
+                // rematches pattern
                 slw->doMatchUpdating();
 
                 // domains update
-                const vector<uint32_t>& wordLetters =
+                const PackedRange<uint32_t> wordLetters =
                     m_model->getWordLetters(slWi);
                 for (uint32_t slwPos = 0; slwPos < wLen; ++slwPos) {
                     const int slwLi = wordLetters[slwPos];
@@ -343,13 +375,13 @@ bool LetterCompiler::assign(const uint32_t li,
 
                     if (remValues.any()) {
                         *crucio_vout << "\tletter " << slwLi <<
-                                     ": removed " << ABMaskString(m_alphabet, remValues) << ", ";
-                        *crucio_vout << "now " << ABMaskString(m_alphabet, *slwDom);
+                                     ": removed " << m_symbols->getMaskString(remValues) << ", ";
+                        *crucio_vout << "now " << m_symbols->getMaskString(*slwDom);
                         *crucio_vout << " (UNIQUE)" << endl;
                     }
 
                     // current assignment invalidated in other words
-                    const uint32_t vi = character2Index(m_alphabet, v);
+                    const uint32_t vi = m_symbols->getIndex(v);
                     if (((uint32_t)slwLi == li) && remValues.test(vi)) {
                         *crucio_vout << "\tletter " << li <<
                                      ": invalidated (UNIQUE)" << endl;
@@ -370,6 +402,11 @@ bool LetterCompiler::assign(const uint32_t li,
                     }
                 }
             }
+
+            // same length words must still get distinct IDs
+            if (!propagateUnique(li, wLen, failed)) {
+                return false;
+            }
         }
     }
 
@@ -397,8 +434,8 @@ bool LetterCompiler::assign(const uint32_t li,
 
         if (remValues.any()) {
             *crucio_vout << "\tletter " << dLi <<
-                         ": removed " << ABMaskString(m_alphabet, remValues) << ", ";
-            *crucio_vout << "now " << ABMaskString(m_alphabet, *dDom) << endl;
+                         ": removed " << m_symbols->getMaskString(remValues) << ", ";
+            *crucio_vout << "now " << m_symbols->getMaskString(*dDom) << endl;
         }
 
         // an empty domain implies failure
@@ -423,43 +460,29 @@ void LetterCompiler::retire(const uint32_t li,
     Letter* const l = m_model->getLetter(li);
 
     // words current letter belongs to
-    const list<LetterPosition>& letterWords = m_model->getLetterWords(li);
+    const PackedRange<LetterPosition> letterWords = m_model->getLetterWords(li);
 
     // removes current value from related words
-    list<LetterPosition>::const_iterator lpIt;
+    PackedRange<LetterPosition>::const_iterator lpIt;
     for (lpIt = letterWords.begin(); lpIt != letterWords.end(); ++lpIt) {
 
         // related word and its length
         const uint32_t wi = lpIt->getWordIndex();
         const uint32_t pos = lpIt->getPosition();
         Word* const w = m_model->getWord(wi);
-        const uint32_t wLen = w->getLength();
 
         // word previously completed, readmit it in same length words
         if (isUnique() && w->isComplete()) {
 
-            // excluded word ID
+            // excluded word ID (none if completion failed as duplicate)
             uint32_t excludedID = w->getID();
             if (excludedID == UINT_MAX) {
                 excludedID = w->removeCustomID();
-                if (excludedID == UINT_MAX) {
-                    continue;
-                }
             }
 
-            // selects words subset by length
-            const map<uint32_t, set<uint32_t> >& wordsByLength =
-                m_model->getWordsByLength();
-            const set<uint32_t>& subset = wordsByLength.find(wLen)->second;
-
-            // updates exclusion lists
-            set<uint32_t>::const_iterator slWiIt;
-            for (slWiIt = subset.begin(); slWiIt != subset.end(); ++slWiIt) {
-                const uint32_t slWi = *slWiIt;
-                Word* const slw = m_model->getWord(slWi);
-
-                // reincludes completed word
-                slw->include(excludedID);
+            // reincludes completed word in all words having same length
+            if (excludedID != UINT_MAX) {
+                w->include(excludedID);
             }
         }
 
@@ -485,3 +508,64 @@ void LetterCompiler::retire(const uint32_t li,
         remStack->pop();
     }
 }
+
+// li = last assigned letter, len = length of the last completed word
+bool LetterCompiler::propagateUnique(const uint32_t li,
+                                     const uint32_t len,
+                                     set<uint32_t>* const failed)
+{
+    const PackedRange<uint32_t> subset = m_model->getWordsByLength(len);
+    PackedRange<uint32_t>::const_iterator slWiIt;
+
+    // incomplete words having length len
+    uint32_t slCount = 0;
+    for (slWiIt = subset.begin(); slWiIt != subset.end(); ++slWiIt) {
+        if (!m_model->getWord(*slWiIt)->isComplete()) {
+            ++slCount;
+        }
+    }
+
+    // words with at least as many matchings as words can always be
+    // matched; unconstrained words are skipped too, their matchings
+    // are only refreshed once a letter is set
+    vector<uint32_t> tightWis;
+    m_allDiff.clear();
+    for (slWiIt = subset.begin(); slWiIt != subset.end(); ++slWiIt) {
+        const Word* const slw = m_model->getWord(*slWiIt);
+        if (slw->isComplete() || (slw->getWildcards() == len)) {
+            continue;
+        }
+
+        const vector<uint32_t>& slIDs = slw->getMatchingResult()->getIDs();
+        if (slIDs.size() < slCount) {
+            m_allDiff.addSlot(slIDs.begin(), slIDs.end());
+            tightWis.push_back(*slWiIt);
+        }
+    }
+    if (tightWis.size() < 2) {
+        return true;
+    }
+
+    // not enough distinct matchings
+    if (!m_allDiff.propagate()) {
+#ifndef CRUCIO_BJ_FAST
+        // adds failed variables orders (tight words unassigned letters)
+        vector<uint32_t>::const_iterator wIt;
+        for (wIt = tightWis.begin(); wIt != tightWis.end(); ++wIt) {
+            const PackedRange<uint32_t> wordLetters = m_model->getWordLetters(*wIt);
+            vector<uint32_t>::const_iterator wlIt;
+            for (wlIt = wordLetters.begin(); wlIt != wordLetters.end(); ++wlIt) {
+                if (((int)*wlIt != -1) && (m_revOrder[*wlIt] > m_revOrder[li])) {
+                    failed->insert(m_revOrder[*wlIt]);
+                }
+            }
+        }
+#endif
+        *crucio_vout << "\tAD failed at length " << len <<
+                     " (UNIQUE)" << endl;
+
+        return false;
+    }
+
+    return true;
+}
@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "common.h"
+#include "AllDifferent.h"
 #include "Backjumper.h"
 #include "Compiler.h"
 
@@ -38,19 +39,22 @@ namespace crucio
         std::vector<std::list<std::pair<uint32_t, LetterPosition> > > m_deps;
         std::vector<std::list<std::pair<uint32_t, LetterPosition> > > m_revDeps;
         Backjumper m_bj;
+        AllDifferent m_allDiff;
 
         // depending on model alphabet
-        Alphabet m_alphabet;
-        uint32_t m_alphabetSize;
+        const SymbolTable* m_symbols;
 
         // subproblems
-        char choose(ABMask* const domainMask);
+        char choose(const uint32_t li, ABMask* const domainMask);
         bool assign(const uint32_t li,
                     const char v,
                     std::stack<std::pair<uint32_t, ABMask> >* const remStack,
                     std::set<uint32_t>* const failed);
         void retire(const uint32_t li,
                     std::stack<std::pair<uint32_t, ABMask> >* const remStack);
+        bool propagateUnique(const uint32_t li,
+                             const uint32_t len,
+                             std::set<uint32_t>* const failed);
     };
 }
 
@@ -0,0 +1,114 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include "MatchCache.h"
+
+using namespace crucio;
+using namespace std;
+
+const uint32_t MatchCache::DEFAULT_CAPACITY;
+
+MatchCache::MatchCache(const uint32_t capacity) :
+    m_entries(),
+    m_index(),
+    m_capacity(capacity),
+    m_bytes(0),
+    m_hits(0),
+    m_misses(0),
+    m_evictions(0),
+    m_key()
+{
+}
+
+MatchCache::~MatchCache()
+{
+    clear();
+}
+
+IDBuffer* MatchCache::find(const string& pattern, const uint64_t signature)
+{
+    if (m_capacity == 0) {
+        return NULL;
+    }
+
+    const map<string, list<Entry>::iterator>::const_iterator iIt =
+        m_index.find(makeKey(pattern, signature));
+    if (iIt == m_index.end()) {
+        ++m_misses;
+        return NULL;
+    }
+    ++m_hits;
+
+    // moves entry on top
+    m_entries.splice(m_entries.begin(), m_entries, iIt->second);
+    return iIt->second->m_buffer;
+}
+
+void MatchCache::insert(const string& pattern, const uint64_t signature,
+                        const MatchingResult* const res)
+{
+    if (m_capacity == 0) {
+        return;
+    }
+
+    // IDs, letter masks saved later and bookkeeping
+    const string& key = makeKey(pattern, signature);
+    const uint32_t bytes = (uint32_t)(res->getSize() * sizeof(uint32_t) +
+                                      pattern.length() * sizeof(ABMask) +
+                                      2 * key.length() + 64);
+    if ((bytes > m_capacity) || (m_index.find(key) != m_index.end())) {
+        return;
+    }
+    evict(bytes);
+
+    IDBuffer* const buffer = res->getBuffer();
+    buffer->retain();
+    m_entries.push_front(Entry(key, buffer, bytes));
+    m_index.insert(make_pair(key, m_entries.begin()));
+    m_bytes += bytes;
+}
+
+void MatchCache::clear()
+{
+    list<Entry>::iterator eIt;
+    for (eIt = m_entries.begin(); eIt != m_entries.end(); ++eIt) {
+        eIt->m_buffer->release();
+    }
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+void MatchCache::setCapacity(const uint32_t capacity)
+{
+    m_capacity = capacity;
+    evict(0);
+}
+
+// pattern followed by signature bytes
+const string& MatchCache::makeKey(const string& pattern,
+                                  const uint64_t signature)
+{
+    m_key.assign(pattern);
+    for (uint32_t i = 0; i < 8; ++i) {
+        m_key.push_back((char)(signature >> (i * 8)));
+    }
+    return m_key;
+}
+
+// drops oldest entries until bytes more fit (no sum, may wrap near 4GB)
+void MatchCache::evict(const uint32_t bytes)
+{
+    while (!m_entries.empty() && ((m_bytes > m_capacity) ||
+                                  (bytes > m_capacity - m_bytes))) {
+        Entry& oldest = m_entries.back();
+
+        m_index.erase(oldest.m_key);
+        m_bytes -= oldest.m_bytes;
+        oldest.m_buffer->release();
+        m_entries.pop_back();
+        ++m_evictions;
+    }
+}
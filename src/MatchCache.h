@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __MATCH_CACHE_H
+#define __MATCH_CACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+
+#include "common.h"
+#include "Dictionary.h"
+
+namespace crucio
+{
+    // LRU cache of matching results, keyed by pattern (hence length)
+    // and exclusions signature, bounded in bytes; buffers are shared
+    // with MatchingResult and never modified while cached
+    class MatchCache
+    {
+    public:
+        static const uint32_t DEFAULT_CAPACITY = 64 << 20;
+
+        explicit MatchCache(const uint32_t capacity = DEFAULT_CAPACITY);
+        ~MatchCache();
+
+        // NULL on miss
+        IDBuffer* find(const std::string& pattern, const uint64_t signature);
+
+        // caches res results, evicting least recently used entries
+        void insert(const std::string& pattern, const uint64_t signature,
+                    const MatchingResult* const res);
+
+        void clear();
+
+        // 0 disables caching
+        uint32_t getCapacity() const {
+            return m_capacity;
+        }
+        void setCapacity(const uint32_t capacity);
+
+        // statistics
+        uint32_t getBytes() const {
+            return m_bytes;
+        }
+        uint32_t getEntries() const {
+            return (uint32_t)m_entries.size();
+        }
+        uint32_t getHits() const {
+            return m_hits;
+        }
+        uint32_t getMisses() const {
+            return m_misses;
+        }
+        uint32_t getEvictions() const {
+            return m_evictions;
+        }
+
+    private:
+        class Entry
+        {
+        public:
+            Entry(const std::string& key, IDBuffer* const buffer,
+                  const uint32_t bytes) :
+                m_key(key),
+                m_buffer(buffer),
+                m_bytes(bytes) {
+            }
+
+            std::string m_key;
+            IDBuffer* m_buffer;
+            uint32_t m_bytes;
+        };
+
+        // most recently used first
+        std::list<Entry> m_entries;
+        std::map<std::string, std::list<Entry>::iterator> m_index;
+
+        uint32_t m_capacity;
+        uint32_t m_bytes;
+
+        uint32_t m_hits;
+        uint32_t m_misses;
+        uint32_t m_evictions;
+
+        // reused key buffer
+        std::string m_key;
+
+        const std::string& makeKey(const std::string& pattern,
+                                   const uint64_t signature);
+        void evict(const uint32_t bytes);
+    };
+}
+
+#endif
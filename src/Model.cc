@@ -3,28 +3,27 @@
 // License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
 //
 
+#include <new>
+
 #include "Model.h"
 
 using namespace crucio;
 using namespace std;
 
 Model::Model(Dictionary* const d, const Grid* const g) :
-    m_alphabet(d->getAlphabet()),
     m_dictionary(d),
     m_grid(g),
-    m_mappings(),
+    m_topology(new Topology(g->getNonBlackCells(), g->getWords())),
+    m_arena(g->getNonBlackCells() * sizeof(Letter) + g->getWords() *
+            (sizeof(Word) + sizeof(MatchingResult) + 2 * Arena::ALIGNMENT) +
+            Arena::ALIGNMENT),
     m_letters(g->getNonBlackCells()),
     m_words(g->getWords()),
-    m_initLetters(g->getNonBlackCells(), ANY_CHAR),
-    m_initLettersDomains(g->getNonBlackCells(), anyMask(d->getAlphabet())),
-    m_lettersWords(g->getNonBlackCells()),
-    m_lettersNeighbours(g->getNonBlackCells()),
-    m_initWords(g->getWords()),
+    m_initLettersDomains(g->getNonBlackCells(), d->getSymbols().getFullMask()),
     m_initWordsDomains(g->getWords()),
-    m_wordsLetters(g->getWords()),
-    m_wordsNeighbours(g->getWords()),
-    m_wordsByLength(),
-    m_overConstrained(false)
+    m_exclusions(),
+    m_overConstrained(false),
+    m_initMatchings()
 {
     // letters and words indexes
     int li, wi;
@@ -38,12 +37,14 @@ Model::Model(Dictionary* const d, const Grid* const g) :
     const Cell* cl = NULL;
 
     // letters/words indexes matrix
-    m_mappings.resize(m_grid->getRows());
+    m_topology->m_mappings.resize(m_grid->getRows());
     for (i = 0; i < m_grid->getRows(); ++i) {
-        m_mappings[i].resize(m_grid->getColumns());
+        m_topology->m_mappings[i].resize(m_grid->getColumns());
     }
 
-    // letters creation
+    // letters creation, contiguous
+    Letter* const lettersBlock =
+        (Letter*) m_arena.allocate(lettersNum * sizeof(Letter));
     li = 0;
     for (i = 0; i < m_grid->getRows(); ++i) {
         for (j = 0; j < m_grid->getColumns(); ++j) {
@@ -57,19 +58,25 @@ Model::Model(Dictionary* const d, const Grid* const g) :
                 j = cl->getColumn();
 
                 // puts letter index in mappings matrix
-                m_mappings[i][j].m_li = li;
+                m_topology->m_mappings[i][j].m_li = li;
 
                 // creates and stores letter into letters vector
-                Letter* const nl = new Letter(cl);
+                Letter* const nl = new (&lettersBlock[li]) Letter(cl);
                 m_letters[li] = nl;
 
                 // initial letter value
                 if (cl->isFixed()) {
-                    const char ch = cl->getValue();
+                    const char ch = getSymbols().fold(cl->getValue());
 
                     // sets value and saves it into init vector
-                    nl->set(ch);
-                    m_initLetters[li] = ch;
+                    if (ch) {
+                        nl->set(ch);
+                        m_topology->m_initLetters[li] = ch;
+                    } else {
+
+                        // fixed values must belong to alphabet
+                        m_overConstrained = true;
+                    }
                 }
 
                 // next letter
@@ -94,7 +101,9 @@ Model::Model(Dictionary* const d, const Grid* const g) :
             if (acrossDef) {
 
                 // creates and stores word into words vector
-                Word* const nw = new Word(m_dictionary, acrossDef);
+                Word* const nw = new (m_arena.allocate(sizeof(Word)))
+                Word(m_dictionary, acrossDef,
+                     &m_exclusions[acrossDef->getLength()], &m_arena);
                 m_words[wi] = nw;
 
                 // cycles through letters in the word
@@ -102,23 +111,17 @@ Model::Model(Dictionary* const d, const Grid* const g) :
                 for (pos = 0; pos < nwLen; ++pos) {
 
                     // puts word index in mappings matrix
-                    m_mappings[i][j + pos].m_wiAcross = wi;
+                    m_topology->m_mappings[i][j + pos].m_wiAcross = wi;
 
                     // puts fixed values in the word
                     const Cell* const nwCl = m_grid->getCell(i, j + pos);
-                    if (!nwCl->isWhite()) {
-                        nw->setAt(pos, nwCl->getValue());
+                    if (nwCl->isFixed() && getSymbols().contains(nwCl->getValue())) {
+                        nw->setAt(pos, getSymbols().fold(nwCl->getValue()));
                     }
                 }
 
                 // saves initial word value into init vector
-                m_initWords[wi] = nw->get();
-
-                // puts word into the (length -> words) map
-                const pair<map<uint32_t, set<uint32_t> >::iterator, bool> res =
-                    m_wordsByLength.insert(make_pair(nwLen, set<uint32_t>()));
-                set<uint32_t>* const subset = &res.first->second;
-                subset->insert(wi);
+                m_topology->m_initWords[wi] = nw->get();
 
                 // next word
                 ++wi;
@@ -128,7 +131,9 @@ Model::Model(Dictionary* const d, const Grid* const g) :
             if (downDef) {
 
                 // creates and stores word into words vector
-                Word* const nw = new Word(m_dictionary, downDef);
+                Word* const nw = new (m_arena.allocate(sizeof(Word)))
+                Word(m_dictionary, downDef,
+                     &m_exclusions[downDef->getLength()], &m_arena);
                 m_words[wi] = nw;
 
                 // cycles through cells in the word
@@ -136,23 +141,17 @@ Model::Model(Dictionary* const d, const Grid* const g) :
                 for (pos = 0; pos < nwLen; ++pos) {
 
                     // puts word index in mappings matrix
-                    m_mappings[i + pos][j].m_wiDown = wi;
+                    m_topology->m_mappings[i + pos][j].m_wiDown = wi;
 
                     // puts fixed values in the word
                     const Cell* const nwCl = m_grid->getCell(i + pos, j);
-                    if (!nwCl->isWhite()) {
-                        nw->setAt(pos, nwCl->getValue());
+                    if (nwCl->isFixed() && getSymbols().contains(nwCl->getValue())) {
+                        nw->setAt(pos, getSymbols().fold(nwCl->getValue()));
                     }
                 }
 
                 // saves initial word value into init vector
-                m_initWords[wi] = nw->get();
-
-                // puts word into the (length -> words) map
-                const pair<map<uint32_t, set<uint32_t> >::iterator, bool> res =
-                    m_wordsByLength.insert(make_pair(nwLen, set<uint32_t>()));
-                set<uint32_t>* const subset = &res.first->second;
-                subset->insert(wi);
+                m_topology->m_initWords[wi] = nw->get();
 
                 // next word
                 ++wi;
@@ -160,7 +159,28 @@ Model::Model(Dictionary* const d, const Grid* const g) :
         }
     }
 
+    // words by length, a row per length up to the longest one; slots
+    // and pairs of letters sharing a word size the links arrays
+    uint32_t maxLen = 0, slots = 0, pairs = 0;
+    for (wi = 0; wi < wordsNum; ++wi) {
+        const uint32_t wLen = m_words[wi]->getLength();
+        maxLen = max(maxLen, wLen);
+        slots += wLen;
+        pairs += wLen * (wLen - 1);
+    }
+    m_topology->m_wordsByLength.reserve(maxLen + 1, wordsNum);
+    for (uint32_t len = 0; len <= maxLen; ++len) {
+        for (wi = 0; wi < wordsNum; ++wi) {
+            if (m_words[wi]->getLength() == len) {
+                m_topology->m_wordsByLength.push(wi);
+            }
+        }
+        m_topology->m_wordsByLength.closeRow();
+    }
+
     // letters links
+    m_topology->m_lettersWords.reserve(lettersNum, slots);
+    m_topology->m_lettersNeighbours.reserve(lettersNum, pairs);
     for (li = 0; li < lettersNum; ++li) {
         const Letter* const l = m_letters[li];
         const Cell* const lCl = l->getCell();
@@ -170,8 +190,8 @@ Model::Model(Dictionary* const d, const Grid* const g) :
         j = lCl->getColumn();
 
         // referred words
-        const int wiAcross = m_mappings[i][j].m_wiAcross;
-        const int wiDown = m_mappings[i][j].m_wiDown;
+        const int wiAcross = m_topology->m_mappings[i][j].m_wiAcross;
+        const int wiDown = m_topology->m_mappings[i][j].m_wiDown;
 
         // across word
         if (wiAcross != -1) {
@@ -185,16 +205,17 @@ Model::Model(Dictionary* const d, const Grid* const g) :
 
             // browses word current letter belongs to
             for (pos = 0; pos < lDefLen; ++pos) {
-                const int lLi = m_mappings[i][j + pos].m_li;
+                const int lLi = m_topology->m_mappings[i][j + pos].m_li;
 
                 // li is with lLi in word wiAcross at position pos
                 if (lLi != li) {
-                    m_lettersNeighbours[li].push_back(
+                    m_topology->m_lettersNeighbours.push(
                         make_pair(lLi, LetterPosition(wiAcross, pos)));
-                }
+                } else {
 
-                // letter lLi belongs to word wiAcross at position pos
-                m_lettersWords[lLi].push_back(LetterPosition(wiAcross, pos));
+                    // letter li belongs to word wiAcross at position pos
+                    m_topology->m_lettersWords.push(LetterPosition(wiAcross, pos));
+                }
             }
         }
 
@@ -210,21 +231,28 @@ Model::Model(Dictionary* const d, const Grid* const g) :
 
             // browses word current letter belongs to
             for (pos = 0; pos < lDefLen; ++pos) {
-                const int lLi = m_mappings[i + pos][j].m_li;
+                const int lLi = m_topology->m_mappings[i + pos][j].m_li;
 
                 // li is with lLi in word wiDown at position pos
                 if (lLi != li) {
-                    m_lettersNeighbours[li].push_back(
+                    m_topology->m_lettersNeighbours.push(
                         make_pair(lLi, LetterPosition(wiDown, pos)));
-                }
+                } else {
 
-                // letter lLi belongs to word wiDown at position pos
-                m_lettersWords[lLi].push_back(LetterPosition(wiDown, pos));
+                    // letter li belongs to word wiDown at position pos
+                    m_topology->m_lettersWords.push(LetterPosition(wiDown, pos));
+                }
             }
         }
+
+        // next letter
+        m_topology->m_lettersNeighbours.closeRow();
+        m_topology->m_lettersWords.closeRow();
     }
 
     // words links
+    m_topology->m_wordsLetters.reserve(wordsNum, slots);
+    m_topology->m_wordsNeighbours.reserve(wordsNum, slots);
     for (wi = 0; wi < wordsNum; ++wi) {
         const Word* const w = m_words[wi];
         const uint32_t wLen = w->getLength();
@@ -235,16 +263,13 @@ Model::Model(Dictionary* const d, const Grid* const g) :
         i = defCl->getRow();
         j = defCl->getColumn();
 
-        // resizes word letters vector to word length
-        m_wordsLetters[wi].resize(wLen);
-
         // browses word depending on its direction
         if (def->getDirection() == Definition::ACROSS) {
             for (pos = 0; pos < wLen; ++pos) {
-                const int wLi = m_mappings[i][j + pos].m_li;
+                const int wLi = m_topology->m_mappings[i][j + pos].m_li;
 
                 // crossing down word
-                const int cWi = m_mappings[i][j + pos].m_wiDown;
+                const int cWi = m_topology->m_mappings[i][j + pos].m_wiDown;
                 if (cWi != -1) {
                     const Definition* const cDef =
                         m_words[cWi]->getDefinition();
@@ -254,19 +279,19 @@ Model::Model(Dictionary* const d, const Grid* const g) :
                     const uint32_t cwPos = i - cDefCl->getRow();
 
                     // wi at position pos crosses word cWi at position cwPos
-                    m_wordsNeighbours[wi].push_back(
+                    m_topology->m_wordsNeighbours.push(
                         make_pair(cWi, WordCrossing(pos, cwPos)));
                 }
 
                 // pos-th letter in word wi is wLi
-                m_wordsLetters[wi][pos] = wLi;
+                m_topology->m_wordsLetters.push(wLi);
             }
         } else {
             for (pos = 0; pos < wLen; ++pos) {
-                const uint32_t wLi = m_mappings[i + pos][j].m_li;
+                const uint32_t wLi = m_topology->m_mappings[i + pos][j].m_li;
 
                 // crossing across word
-                const int cWi = m_mappings[i + pos][j].m_wiAcross;
+                const int cWi = m_topology->m_mappings[i + pos][j].m_wiAcross;
                 if (cWi != -1) {
                     const Definition* const cDef =
                         m_words[cWi]->getDefinition();
@@ -276,14 +301,34 @@ Model::Model(Dictionary* const d, const Grid* const g) :
                     const uint32_t cwPos = j - cDefCl->getColumn();
 
                     // wi at position pos crosses word cWi at position cwPos
-                    m_wordsNeighbours[wi].push_back(
+                    m_topology->m_wordsNeighbours.push(
                         make_pair(cWi, WordCrossing(pos, cwPos)));
                 }
 
                 // pos-th letter in word wi is wLi
-                m_wordsLetters[wi][pos] = wLi;
+                m_topology->m_wordsLetters.push(wLi);
             }
         }
+
+        // next word
+        m_topology->m_wordsNeighbours.closeRow();
+        m_topology->m_wordsLetters.closeRow();
+    }
+
+    // independent subproblems
+    computeComponents();
+
+    // lengths missing from dictionary make the grid unfillable, no need
+    // to match anything
+    for (uint32_t len = 0; len < m_topology->m_wordsByLength.getRowsNum(); ++len) {
+        if (!m_topology->m_wordsByLength[len].empty() &&
+                !m_dictionary->supportsLength(len)) {
+            *crucio_vout << "unsupported word length " << len << endl;
+            m_overConstrained = true;
+        }
+    }
+    if (m_overConstrained) {
+        return;
     }
 
     // first matchings
@@ -301,20 +346,148 @@ Model::Model(Dictionary* const d, const Grid* const g) :
 //            return;
 //        }
     }
+
+    // reset() starts from here
+    saveSnapshot();
 }
 
 Model::~Model()
 {
-    // letters
-    vector<Letter*>::iterator lIt;
-    for (lIt = m_letters.begin(); lIt != m_letters.end(); ++lIt) {
-        delete *lIt;
-    }
-
-    // words
+    // words own heap buffers (letters don't), memory goes with arena
     vector<Word*>::iterator wIt;
     for (wIt = m_words.begin(); wIt != m_words.end(); ++wIt) {
-        delete *wIt;
+        (*wIt)->~Word();
+    }
+
+    vector<IDBuffer*>::iterator bIt;
+    for (bIt = m_initMatchings.begin(); bIt != m_initMatchings.end(); ++bIt) {
+        (*bIt)->release();
+    }
+
+    m_topology->release();
+}
+
+Model::Model(const Model& source, Dictionary* const d) :
+    m_dictionary(d),
+    m_grid(source.m_grid),
+    m_topology(source.m_topology),
+    m_arena(source.m_arena.getBytes()),
+    m_letters(source.m_letters.size()),
+    m_words(source.m_words.size()),
+    m_initLettersDomains(source.m_initLettersDomains),
+    m_initWordsDomains(source.m_initWordsDomains),
+    m_exclusions(source.m_exclusions),
+    m_overConstrained(source.m_overConstrained),
+    m_initMatchings()
+{
+    const uint32_t lettersNum = (uint32_t)m_letters.size();
+    const uint32_t wordsNum = (uint32_t)m_words.size();
+    uint32_t li, wi;
+
+    m_topology->retain();
+
+    // same layout as source, fits the first chunk
+    Letter* const lettersBlock =
+        (Letter*) m_arena.allocate(lettersNum * sizeof(Letter));
+    for (li = 0; li < lettersNum; ++li) {
+        const Letter* const sl = source.m_letters[li];
+        Letter* const nl = new (&lettersBlock[li]) Letter(sl->getCell());
+        nl->set(sl->get());
+        m_letters[li] = nl;
+    }
+
+    // first matchings copied, nothing mutable is shared with source
+    map<const IDBuffer*, IDBuffer*> copies;
+    m_initMatchings.reserve(source.m_initMatchings.size());
+    vector<IDBuffer*>::const_iterator bIt;
+    for (bIt = source.m_initMatchings.begin(); bIt != source.m_initMatchings.end(); ++bIt) {
+        IDBuffer* const copy = (*bIt)->copy();
+        m_initMatchings.push_back(copy);
+        copies[*bIt] = copy;
+    }
+
+    // patterns and masks copied, matchings too unless still the first
+    // ones (then shared with own snapshot, copy on write)
+    for (wi = 0; wi < wordsNum; ++wi) {
+        const Word* const sw = source.m_words[wi];
+        const uint32_t len = sw->getLength();
+
+        Word* const nw = new (m_arena.allocate(sizeof(Word)))
+        Word(m_dictionary, sw->getDefinition(), &m_exclusions[len], &m_arena);
+        nw->set(sw->get());
+        IDBuffer* const sBuffer = sw->getMatchings()->getBuffer();
+        const map<const IDBuffer*, IDBuffer*>::const_iterator cIt = copies.find(sBuffer);
+        if (cIt != copies.end()) {
+            nw->getMatchings()->share(cIt->second);
+        } else {
+            nw->getMatchings()->assign(sBuffer);
+        }
+        nw->getAllowed() = sw->getAllowed();
+        m_words[wi] = nw;
+    }
+}
+
+Model* Model::clone(Dictionary* const d) const
+{
+    if (d && (d->getIndex() != m_dictionary->getIndex())) {
+        throw CrucioException("model: clone dictionary numbers words differently");
+    }
+    return new Model(*this, (d ? d : m_dictionary));
+}
+
+void Model::reset()
+{
+    const uint32_t wordsNum = (uint32_t)m_words.size();
+    uint32_t li, wi;
+
+    // readmits all words
+    map<uint32_t, IDBitmap>::iterator xIt;
+    for (xIt = m_exclusions.begin(); xIt != m_exclusions.end(); ++xIt) {
+        xIt->second.clear();
+    }
+
+    // sets letters to initial value
+    for (li = 0; li < m_letters.size(); ++li) {
+        m_letters[li]->set(m_topology->m_initLetters[li]);
+    }
+
+    // sets words to initial value, matchings and masks as first computed
+    for (wi = 0; wi < wordsNum; ++wi) {
+        Word* const w = m_words[wi];
+        w->set(m_topology->m_initWords[wi]);
+
+        // no snapshot if overconstrained at construction
+        if (m_initMatchings.empty()) {
+            w->doMatchUpdating();
+            continue;
+        }
+
+        w->getMatchings()->share(m_initMatchings[wi]);
+        const PackedRange<ABMask> allowed = m_topology->m_initAllowed[wi];
+        copy(allowed.begin(), allowed.end(), w->getAllowed().begin());
+    }
+}
+
+void Model::saveSnapshot()
+{
+    const uint32_t wordsNum = (uint32_t)m_words.size();
+
+    m_initMatchings.reserve(wordsNum);
+    m_topology->m_initAllowed.reserve(wordsNum,
+                                      m_topology->m_wordsLetters.getElementsNum());
+    for (uint32_t wi = 0; wi < wordsNum; ++wi) {
+        const Word* const w = m_words[wi];
+
+        IDBuffer* const buffer = w->getMatchings()->getBuffer();
+        buffer->retain();
+        m_initMatchings.push_back(buffer);
+
+        const vector<ABMask>& allowed = w->getAllowed();
+        vector<ABMask>::const_iterator aIt;
+        for (aIt = allowed.begin(); aIt != allowed.end(); ++aIt) {
+            m_topology->m_initAllowed.push(*aIt);
+        }
+        m_topology->m_initAllowed.closeRow();
     }
 }
 
@@ -330,7 +503,7 @@ void Model::computeLetterDomains()
         const uint32_t wLen = w->getLength();
 
         // updates domains of owned letters (initially ANY_MASK)
-        const vector<uint32_t>& wiLetters = m_wordsLetters[wi];
+        const PackedRange<uint32_t> wiLetters = m_topology->m_wordsLetters[wi];
         for (pos = 0; pos < wLen; ++pos) {
             const uint32_t wLi = wiLetters[pos];
             ABMask* const wlDom = &m_initLettersDomains[wLi];
@@ -344,6 +517,144 @@ void Model::computeLetterDomains()
     }
 }
 
+// iterative Tarjan visit over unassigned letters, a component per tree
+void Model::computeComponents()
+{
+    const uint32_t NONE = UINT_MAX;
+    const uint32_t lettersNum = (uint32_t)m_letters.size();
+    const uint32_t wordsNum = (uint32_t)m_words.size();
+    uint32_t li, wi;
+
+    // discovery times and lowest reachable times
+    vector<uint32_t> discovery(lettersNum, NONE);
+    vector<uint32_t> low(lettersNum, 0);
+    vector<bool> articulation(lettersNum, false);
+    uint32_t counter = 0;
+
+    // DFS stack of <letter, next neighbour>
+    vector<pair<uint32_t, PackedRange<pair<uint32_t, LetterPosition> >::const_iterator> > toVisit;
+    vector<uint32_t> parent(lettersNum, NONE);
+
+    m_topology->m_componentsNum = 0;
+    for (li = 0; li < lettersNum; ++li) {
+        if (discovery[li] != NONE) {
+            continue;
+        }
+
+        // fixed letters link nothing
+        if (m_topology->m_initLetters[li] != ANY_CHAR) {
+            discovery[li] = counter++;
+            m_topology->m_lettersComponents[li] = m_topology->m_componentsNum++;
+            continue;
+        }
+
+        // new tree root
+        uint32_t rootChildren = 0;
+        discovery[li] = low[li] = counter++;
+        m_topology->m_lettersComponents[li] = m_topology->m_componentsNum;
+        toVisit.push_back(make_pair(li, m_topology->m_lettersNeighbours[li].begin()));
+
+        while (!toVisit.empty()) {
+            const uint32_t vLi = toVisit.back().first;
+            PackedRange<pair<uint32_t, LetterPosition> >::const_iterator& nbIt =
+                toVisit.back().second;
+
+            // next unassigned neighbour
+            if (nbIt != m_topology->m_lettersNeighbours[vLi].end()) {
+                const uint32_t nLi = nbIt->first;
+                ++nbIt;
+
+                if (m_topology->m_initLetters[nLi] != ANY_CHAR) {
+                    continue;
+                }
+                if (discovery[nLi] == NONE) {
+                    discovery[nLi] = low[nLi] = counter++;
+                    parent[nLi] = vLi;
+                    m_topology->m_lettersComponents[nLi] = m_topology->m_componentsNum;
+                    if (vLi == li) {
+                        ++rootChildren;
+                    }
+                    toVisit.push_back(make_pair(nLi,
+                                                m_topology->m_lettersNeighbours[nLi].begin()));
+                } else if (nLi != parent[vLi]) {
+                    low[vLi] = min(low[vLi], discovery[nLi]);
+                }
+                continue;
+            }
+
+            // vLi done, updates parent
+            toVisit.pop_back();
+            const uint32_t pLi = parent[vLi];
+            if (pLi != NONE) {
+                low[pLi] = min(low[pLi], low[vLi]);
+                if ((pLi != li) && (low[vLi] >= discovery[pLi])) {
+                    articulation[pLi] = true;
+                }
+            }
+        }
+
+        // root splits only with more subtrees
+        articulation[li] = (rootChildren > 1);
+        ++m_topology->m_componentsNum;
+    }
+
+    m_topology->m_articulations.clear();
+    for (li = 0; li < lettersNum; ++li) {
+        if (articulation[li]) {
+            m_topology->m_articulations.push_back(li);
+        }
+    }
+
+    // words from their unassigned letters, all in the same component
+    for (wi = 0; wi < wordsNum; ++wi) {
+        const PackedRange<uint32_t> wordLetters = m_topology->m_wordsLetters[wi];
+        PackedRange<uint32_t>::const_iterator lIt;
+
+        m_topology->m_wordsComponents[wi] = NONE;
+        for (lIt = wordLetters.begin(); lIt != wordLetters.end(); ++lIt) {
+            if (m_topology->m_initLetters[*lIt] == ANY_CHAR) {
+                m_topology->m_wordsComponents[wi] =
+                    m_topology->m_lettersComponents[*lIt];
+                break;
+            }
+        }
+        if (m_topology->m_wordsComponents[wi] == NONE) {
+            m_topology->m_wordsComponents[wi] = m_topology->m_componentsNum++;
+        }
+    }
+}
+
+void Model::saveLetters(vector<char>* const values) const
+{
+    const uint32_t lettersNum = (uint32_t)m_letters.size();
+    values->resize(lettersNum);
+
+    // first word the letter belongs to
+    for (uint32_t li = 0; li < lettersNum; ++li) {
+        const LetterPosition& lp = m_topology->m_lettersWords[li].front();
+        (*values)[li] = m_words[lp.getWordIndex()]->getAt(lp.getPosition());
+    }
+}
+
+void Model::restoreLetters(const vector<char>& values)
+{
+    uint32_t li, wi, pos;
+
+    for (li = 0; li < m_letters.size(); ++li) {
+        m_letters[li]->set(values[li]);
+    }
+
+    // words patterns from their letters
+    for (wi = 0; wi < m_words.size(); ++wi) {
+        const PackedRange<uint32_t> wordLetters = m_topology->m_wordsLetters[wi];
+        string mask(wordLetters.size(), ANY_CHAR);
+        for (pos = 0; pos < wordLetters.size(); ++pos) {
+            mask[pos] = values[wordLetters[pos]];
+        }
+        m_words[wi]->set(mask);
+    }
+}
+
 // WARNING: very high memory usage
 void Model::computeWordDomains()
 {
@@ -13,9 +13,11 @@
 #include <string>
 #include <vector>
 
+#include "Arena.h"
 #include "Dictionary.h"
 #include "Grid.h"
 #include "Letter.h"
+#include "PackedArray.h"
 #include "Word.h"
 
 namespace crucio
@@ -69,9 +71,16 @@ namespace crucio
         Model(Dictionary* const d, const Grid* const g);
         ~Model();
 
+        // same state on shared structure, no matching involved; the
+        // clone matches through d (source dictionary if NULL), which must
+        // number words alike (e.g. a view with its own matcher for
+        // another thread) and gets private ID buffers; source must not
+        // be searched while cloning
+        Model* clone(Dictionary* const d = NULL) const;
+
         // model alphabet
-        Alphabet getAlphabet() const {
-            return m_alphabet;
+        const SymbolTable& getSymbols() const {
+            return m_dictionary->getSymbols();
         }
 
         const Grid* getGrid() const {
@@ -99,7 +108,7 @@ namespace crucio
             return m_letters[li];
         }
         int getLetterIndexByPos(const uint32_t i, const uint32_t j) const {
-            return m_mappings[i][j].m_li;
+            return m_topology->m_mappings[i][j].m_li;
         }
 
         // words
@@ -118,8 +127,8 @@ namespace crucio
         int getWordIndexByPos(const Definition::Direction dir,
                               const uint32_t i, const uint32_t j) const {
             return ((dir == Definition::ACROSS) ?
-                    m_mappings[i][j].m_wiAcross :
-                    m_mappings[i][j].m_wiDown);
+                    m_topology->m_mappings[i][j].m_wiAcross :
+                    m_topology->m_mappings[i][j].m_wiDown);
         }
 
         // links from letters
@@ -129,12 +138,12 @@ namespace crucio
         ABMask getInitLetterDomain(const uint32_t li) const {
             return m_initLettersDomains[li];
         }
-        const std::list<LetterPosition>& getLetterWords(const uint32_t li) const {
-            return m_lettersWords[li];
+        PackedRange<LetterPosition> getLetterWords(const uint32_t li) const {
+            return m_topology->m_lettersWords[li];
         }
-        const std::list<std::pair<uint32_t, LetterPosition> >&
+        PackedRange<std::pair<uint32_t, LetterPosition> >
         getLetterNeighbours(const uint32_t li) const {
-            return m_lettersNeighbours[li];
+            return m_topology->m_lettersNeighbours[li];
         }
 
         // links from words
@@ -144,23 +153,51 @@ namespace crucio
         const std::set<uint32_t>& getInitWordDomain(const uint32_t wi) const {
             return m_initWordsDomains[wi];
         }
-        const std::vector<uint32_t>& getWordLetters(const uint32_t wi) const {
-            return m_wordsLetters[wi];
+        PackedRange<uint32_t> getWordLetters(const uint32_t wi) const {
+            return m_topology->m_wordsLetters[wi];
         }
         const uint32_t getWordLetter(const uint32_t wi, const uint32_t pos) const {
-            return m_wordsLetters[wi][pos];
+            return m_topology->m_wordsLetters[wi][pos];
         }
-        const std::list<std::pair<uint32_t, WordCrossing> >&
+        PackedRange<std::pair<uint32_t, WordCrossing> >
         getWordNeighbours(const uint32_t wi) const {
-            return m_wordsNeighbours[wi];
+            return m_topology->m_wordsNeighbours[wi];
+        }
+
+        // maps words given their length (a row per length, ascending
+        // word indexes, empty rows for missing lengths)
+        const PackedArray<uint32_t>& getWordsByLength() const {
+            return m_topology->m_wordsByLength;
+        }
+        PackedRange<uint32_t> getWordsByLength(const uint32_t len) const {
+            if (len >= m_topology->m_wordsByLength.getRowsNum()) {
+                return PackedRange<uint32_t>(NULL, NULL);
+            }
+            return m_topology->m_wordsByLength[len];
         }
 
-        // maps words given their length
-        const std::map<uint32_t, std::set<uint32_t> >& getWordsByLength() const {
-            return m_wordsByLength;
+        // independent subproblems: components of letters linked by
+        // words through unassigned letters; every fixed letter and every
+        // fully fixed word makes a component of its own
+        uint32_t getComponentsNum() const {
+            return m_topology->m_componentsNum;
+        }
+        const std::vector<uint32_t>& getLettersComponents() const {
+            return m_topology->m_lettersComponents;
+        }
+        uint32_t getLetterComponent(const uint32_t li) const {
+            return m_topology->m_lettersComponents[li];
+        }
+        const std::vector<uint32_t>& getWordsComponents() const {
+            return m_topology->m_wordsComponents;
+        }
+        uint32_t getWordComponent(const uint32_t wi) const {
+            return m_topology->m_wordsComponents[wi];
         }
-        const std::set<uint32_t>& getWordsByLength(const uint32_t len) const {
-            return m_wordsByLength.find(len)->second;
+
+        // unassigned letters splitting their component once assigned
+        const std::vector<uint32_t>& getArticulations() const {
+            return m_topology->m_articulations;
         }
 
         // true if model has no solutions, i.e. empty domains
@@ -168,21 +205,16 @@ namespace crucio
             return m_overConstrained;
         }
 
-        void reset() {
+        // letters as read through words, which compilers keep up to
+        // date during search (letters are only set on success)
+        void saveLetters(std::vector<char>* const values) const;
 
-            // sets letters to initial value
-            for (uint32_t li = 0; li < m_letters.size(); ++li) {
-                Letter* const l = m_letters[li];
-                l->set(m_initLetters[li]);
-            }
+        // sets letters and words patterns from saved values, matchings
+        // are left untouched
+        void restoreLetters(const std::vector<char>& values);
 
-            // sets words to initial value
-            for (uint32_t wi = 0; wi < m_words.size(); ++wi) {
-                Word* const w = m_words[wi];
-                w->set(m_initWords[wi]);
-                w->doMatchUpdating();
-            }
-        }
+        // back to the state right after construction, from snapshot
+        void reset();
 
     private:
 
@@ -201,39 +233,109 @@ namespace crucio
             }
         };
 
-        // model alphabet with related dictionary
-        const Alphabet m_alphabet;
+        // structure built once by the first model and shared, read-only,
+        // by its clones
+        class Topology
+        {
+        public:
+            Topology(const uint32_t lettersNum, const uint32_t wordsNum) :
+                m_mappings(),
+                m_initLetters(lettersNum, ANY_CHAR),
+                m_lettersWords(),
+                m_lettersNeighbours(),
+                m_initWords(wordsNum),
+                m_wordsLetters(),
+                m_wordsNeighbours(),
+                m_wordsByLength(),
+                m_initAllowed(),
+                m_componentsNum(0),
+                m_lettersComponents(lettersNum),
+                m_wordsComponents(wordsNum),
+                m_articulations(),
+                m_refs(1) {
+            }
+
+            // references, clones may live on other threads
+            void retain() {
+                incrementRefs(&m_refs);
+            }
+            void release() {
+                if (decrementRefs(&m_refs) == 0) {
+                    delete this;
+                }
+            }
+
+            // helper data structure
+            std::vector<std::vector<LWInfo> > m_mappings;
+
+            // links from letters, packed by letter index
+            std::vector<char> m_initLetters;
+            PackedArray<LetterPosition> m_lettersWords;
+            PackedArray<std::pair<uint32_t, LetterPosition> > m_lettersNeighbours;
+
+            // links from words, packed by word index
+            std::vector<std::string> m_initWords;
+            PackedArray<uint32_t> m_wordsLetters;
+            PackedArray<std::pair<uint32_t, WordCrossing> > m_wordsNeighbours;
+
+            // maps words given their length, packed by length
+            PackedArray<uint32_t> m_wordsByLength;
+
+            // first letter masks, restored by reset() along with the
+            // model first matchings
+            PackedArray<ABMask> m_initAllowed;
+
+            // components and articulation letters
+            uint32_t m_componentsNum;
+            std::vector<uint32_t> m_lettersComponents;
+            std::vector<uint32_t> m_wordsComponents;
+            std::vector<uint32_t> m_articulations;
+
+        private:
+            volatile uint32_t m_refs;
+        };
+
+        // model dictionary (and alphabet)
         Dictionary* const m_dictionary;
 
         // grid reference
         const Grid* const m_grid;
 
-        // helper data structure
-        std::vector<std::vector<LWInfo> > m_mappings;
+        // shared structure
+        Topology* const m_topology;
+
+        // letters block, then each word followed by its matching result
+        // (a single chunk, cloned at once)
+        Arena m_arena;
 
         // letters and words
         std::vector<Letter*> m_letters;
         std::vector<Word*> m_words;
 
-        // links from letters
-        std::vector<char> m_initLetters;
+        // domains, narrowed by compilers
         std::vector<ABMask> m_initLettersDomains;
-        std::vector<std::list<LetterPosition> > m_lettersWords;
-        std::vector<std::list<std::pair<uint32_t, LetterPosition> > >
-        m_lettersNeighbours;
-
-        // links from words
-        std::vector<std::string> m_initWords;
         std::vector<std::set<uint32_t> > m_initWordsDomains;
-        std::vector<std::vector<uint32_t> > m_wordsLetters;
-        std::vector<std::list<std::pair<uint32_t, WordCrossing> > >
-        m_wordsNeighbours;
 
-        // maps words given their length
-        std::map<uint32_t, std::set<uint32_t> > m_wordsByLength;
+        // IDs in use by length, shared by same length words (--unique)
+        std::map<uint32_t, IDBitmap> m_exclusions;
 
         // overconstrained flag
         bool m_overConstrained;
+
+        // first matchings (shared buffers, copy on write), restored by
+        // reset() instead of matching again
+        std::vector<IDBuffer*> m_initMatchings;
+
+        // clones current state
+        Model(const Model& source, Dictionary* const d);
+
+        // non copyable
+        Model(const Model&);
+        Model& operator=(const Model&);
+
+        // topology setup, only at construction
+        void computeComponents();
+        void saveSnapshot();
     };
 }
 
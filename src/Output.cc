@@ -29,7 +29,8 @@ void crucio::printInputDescription(ostream& out,
     // input files
 //    out << "dictionary = '" << d.getFilename() << "', " <<
 //            d.getSize() << " valid words" << endl;
-    out << "dictionary = " << d.getSize() << " valid words" << endl;
+    out << "dictionary = " << d.getSize() << " valid words, " <<
+        d.getSymbols().getSize() << " symbols alphabet" << endl;
     out << "grid = '"  << g.getFilename() << "', " <<
         g.getRows() << "x" << g.getColumns() << ", " <<
         "interlock degree " << g.getInterlockDegree() << "%" << endl;
@@ -67,6 +68,8 @@ void crucio::printModelDescription(ostream& out, const Model& m)
 
     out << "letters = " << lettersNum << endl;
     out << "words = " << wordsNum << endl;
+    out << "components = " << m.getComponentsNum() <<
+        ", articulation letters = " << m.getArticulations().size() << endl;
     out << endl;
 
     // letters
@@ -81,9 +84,9 @@ void crucio::printModelDescription(ostream& out, const Model& m)
             lCl->getColumn() << ")" << endl;
 
         // words it belongs to
-        const list<LetterPosition>& letterWords = m.getLetterWords(li);
+        const PackedRange<LetterPosition> letterWords = m.getLetterWords(li);
         out << "\tbelongs to: ";
-        list<LetterPosition>::const_iterator lpIt;
+        PackedRange<LetterPosition>::const_iterator lpIt;
         for (lpIt = letterWords.begin(); lpIt != letterWords.end(); ++lpIt) {
             const uint32_t wi = lpIt->getWordIndex();
             const uint32_t pos = lpIt->getPosition();
@@ -113,9 +116,9 @@ void crucio::printModelDescription(ostream& out, const Model& m)
             defCl->getColumn() << ")" << endl;
 
         // letters
-        const vector<uint32_t>& wordLetters = m.getWordLetters(wi);
+        const PackedRange<uint32_t> wordLetters = m.getWordLetters(wi);
         out << "\tcontains: ";
-        vector<uint32_t>::const_iterator lIt;
+        PackedRange<uint32_t>::const_iterator lIt;
         for (lIt = wordLetters.begin(); lIt != wordLetters.end(); ++lIt) {
             const int li = *lIt;
             out << "l" << li;
@@ -124,10 +127,10 @@ void crucio::printModelDescription(ostream& out, const Model& m)
         out << endl;
 
         // crossings (vector is never empty if no isolated cells in the grid)
-        const list<pair<uint32_t, WordCrossing> >& neighbours =
+        const PackedRange<pair<uint32_t, WordCrossing> > neighbours =
             m.getWordNeighbours(wi);
         out << "\tcrossings: ";
-        list<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
+        PackedRange<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
         for (nbIt = neighbours.begin(); nbIt != neighbours.end(); ++nbIt) {
             const uint32_t cwi = nbIt->first;
             const uint32_t pos = nbIt->second.getPosition();
@@ -270,13 +273,49 @@ void crucio::printOutput(ostream& out, const Model& m)
     }
 }
 
+void crucio::printMatchCacheStatistics(ostream& out, const MatchCache& c)
+{
+    const uint32_t lookups = c.getHits() + c.getMisses();
+
+    out << "lookups = " << lookups << ", hits = " << c.getHits();
+    if (lookups > 0) {
+        out << " (" << (100 * (uint64_t)c.getHits() / lookups) << "%)";
+    }
+    out << endl;
+    out << "entries = " << c.getEntries() << ", " << c.getBytes() <<
+        " of " << c.getCapacity() << " bytes, " << c.getEvictions() <<
+        " evictions" << endl;
+
+    out << endl;
+}
+
+/* OutputSink */
+
+bool OutputSink::put(const Model& m, const uint32_t n)
+{
+    if (m_textOut) {
+        *m_textOut << "[SOLUTION " << n << "]" << endl << endl;
+        printOutput(*m_textOut, m);
+    }
+
+    // raw outputs are concatenated, each one ends with its flags
+    if (m_rawOut) {
+        const Output outData(m);
+        outData.printRaw(*m_rawOut);
+        m_rawOut->flush();
+    }
+
+    return true;
+}
+
 /* Output */
 
-Output::Output(const Model& m) :
+Output::Output(const Model& m, const bool partial) :
     m_rows(0),
     m_columns(0),
     m_cellsData(),
-    m_defsData()
+    m_defsData(),
+    m_partial(partial)
 {
     uint32_t i, j;
     uint32_t wi;
@@ -343,7 +382,8 @@ Output::Output(istream& in) :
     m_rows(0),
     m_columns(0),
     m_cellsData(),
-    m_defsData()
+    m_defsData(),
+    m_partial(false)
 {
     // 32-bit integer buffer (big endian)
     char numBuf[4];
@@ -381,7 +421,7 @@ Output::Output(istream& in) :
     }
 
     // loads final words
-    char wordBuf[Dictionary::MAX_LENGTH + 1];
+    char wordBuf[Grid::MAX_SIZE + 1];
     in.read(numBuf, 4);
     const unsigned long wordsNum = bytesToLong(numBuf);
     for (wi = 0; wi < wordsNum; ++wi) {
@@ -408,6 +448,13 @@ Output::Output(istream& in) :
         m_cellsData[i][j].m_number = dData.getNumber();
     }
 
+    // trailing flags, missing in older files
+    if (in.read(numBuf, 4)) {
+        m_partial = ((bytesToLong(numBuf) & FLAG_PARTIAL) != 0);
+    } else {
+        in.clear();
+    }
+
     // deallocates temporary buffers
     delete[] gridBuf;
 
@@ -483,6 +530,10 @@ void Output::printRaw(ostream& out) const
         out.write(str.c_str(), (unsigned long) str.length());
     }
 
+    // writes flags
+    longToBytes((unsigned long) (m_partial ? FLAG_PARTIAL : 0), numBuf);
+    out.write(numBuf, 4);
+
     // deallocates temporary buffers
     delete[] gridBuf;
 }
@@ -513,9 +564,15 @@ void Output::printLatex(ostream& out,
                 puzzleOut << "[" << cData.m_number << "]";
             }
 
-            // black cells conversion
+            // black cells conversion, partial fill leaves blanks
             const char filledCh = cData.m_filled;
-            puzzleOut << ((filledCh == Cell::BLACK) ? '*' : filledCh);
+            if (filledCh == Cell::BLACK) {
+                puzzleOut << '*';
+            } else if (filledCh == ANY_CHAR) {
+                puzzleOut << "{}";
+            } else {
+                puzzleOut << filledCh;
+            }
         }
         puzzleOut << "|." << endl;
     }
@@ -598,6 +655,11 @@ void Output::printLatex(ostream& out,
     out << "\\renewcommand{\\PuzzleWordsText}[1]{\\textbf{#1 letters} -- }" <<
         endl;
 
+    // incomplete solution
+    if (m_partial) {
+        out << "% partial fill" << endl;
+    }
+
     // begin
     out << "\\begin{document}" << endl;
 
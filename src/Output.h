@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "endian.h"
+#include "MatchCache.h"
 #include "Model.h"
 
 namespace crucio
@@ -30,14 +31,47 @@ namespace crucio
     void printModelDescription(std::ostream& out, const Model& m);
     void printModelGrid(std::ostream& out, const Model& m);
     void printOutput(std::ostream& out, const Model& m);
+    void printMatchCacheStatistics(std::ostream& out, const MatchCache& c);
+
+// solutions consumer for enumeration
+    class SolutionSink
+    {
+    public:
+        virtual ~SolutionSink() {
+        }
+
+        // n = 1-based solution number, false stops enumeration
+        virtual bool put(const Model& m, const uint32_t n) = 0;
+    };
+
+// prints each solution and appends its raw output (either may be NULL)
+    class OutputSink : public SolutionSink
+    {
+    public:
+        OutputSink(std::ostream* const textOut, std::ostream* const rawOut) :
+            m_textOut(textOut),
+            m_rawOut(rawOut) {
+        }
+
+        virtual bool put(const Model& m, const uint32_t n);
+
+    private:
+        std::ostream* m_textOut;
+        std::ostream* m_rawOut;
+    };
 
 // crucio output manager
     class Output
     {
     public:
-        Output(const Model& m);
+        // partial marks a fill left incomplete by an interrupted search
+        Output(const Model& m, const bool partial = false);
         Output(std::istream& in);
 
+        bool isPartial() const {
+            return m_partial;
+        }
+
         void printRaw(std::ostream& out) const;
         void printLatex(std::ostream& out,
                         const bool solution = false,
@@ -102,6 +136,11 @@ namespace crucio
             std::string m_string;
         };
 
+        // raw output trailing flags
+        enum Flags {
+            FLAG_PARTIAL = 0x1
+        };
+
         class IsDown
         {
         public:
@@ -114,6 +153,7 @@ namespace crucio
         uint32_t m_columns;
         std::vector<std::vector<CellData> > m_cellsData;
         std::set<DefinitionData> m_defsData;
+        bool m_partial;
     };
 }
 
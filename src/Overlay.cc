@@ -0,0 +1,67 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include "Overlay.h"
+
+using namespace crucio;
+using namespace std;
+
+Overlay::Overlay() :
+    m_layers(),
+    m_layersNum(0)
+{
+}
+
+Overlay::Overlay(const Overlay& source) :
+    m_layers(),
+    m_layersNum(0)
+{
+    *this = source;
+}
+
+Overlay::~Overlay()
+{
+    clear();
+}
+
+Overlay& Overlay::operator=(const Overlay& source)
+{
+    if (this == &source) {
+        return *this;
+    }
+
+    clear();
+    m_layers.resize(source.m_layers.size(), NULL);
+    for (uint32_t len = 0; len < source.m_layers.size(); ++len) {
+        if (source.m_layers[len]) {
+            m_layers[len] = new Layer(*source.m_layers[len]);
+        }
+    }
+    m_layersNum = source.m_layersNum;
+
+    return *this;
+}
+
+void Overlay::clear()
+{
+    vector<Layer*>::iterator lIt;
+    for (lIt = m_layers.begin(); lIt != m_layers.end(); ++lIt) {
+        delete *lIt;
+    }
+    m_layers.clear();
+    m_layersNum = 0;
+}
+
+Overlay::Layer* Overlay::createLayer(const uint32_t len)
+{
+    if (len >= m_layers.size()) {
+        m_layers.resize(len + 1, NULL);
+    }
+    if (!m_layers[len]) {
+        m_layers[len] = new Layer();
+        ++m_layersNum;
+    }
+    return m_layers[len];
+}
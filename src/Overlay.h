@@ -0,0 +1,102 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __OVERLAY_H
+#define __OVERLAY_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "IDBitmap.h"
+
+namespace crucio
+{
+    // mutable words layered over an immutable WordSetIndex, one layer
+    // per length: added words take IDs right past their base word set
+    // (so merged IDs stay ascending), banned IDs may be base or added
+    class Overlay
+    {
+    public:
+        class Layer
+        {
+        public:
+            Layer() :
+                m_added(),
+                m_addedScores(),
+                m_addedIDs(),
+                m_banned(),
+                m_scored(false) {
+            }
+
+            // added word i has ID base size + i
+            std::vector<std::string> m_added;
+            std::vector<uint32_t> m_addedScores;
+            std::map<std::string, uint32_t> m_addedIDs;
+            IDBitmap m_banned;
+
+            // added scores differ from the loaded (or first added) one
+            bool m_scored;
+        };
+
+        Overlay();
+        Overlay(const Overlay& source);
+        ~Overlay();
+
+        Overlay& operator=(const Overlay& source);
+
+        bool isEmpty() const {
+            return (m_layersNum == 0);
+        }
+        void clear();
+
+        // NULL if nothing changed at this length
+        const Layer* getLayer(const uint32_t len) const {
+            return (len < m_layers.size() ? m_layers[len] : NULL);
+        }
+        Layer* getLayer(const uint32_t len) {
+            return (len < m_layers.size() ? m_layers[len] : NULL);
+        }
+        Layer* createLayer(const uint32_t len);
+
+        // every layer length is below this
+        uint32_t getLengthBound() const {
+            return (uint32_t)m_layers.size();
+        }
+
+        // words count change at this length
+        uint32_t getAddedNum(const uint32_t len) const {
+            const Layer* const layer = getLayer(len);
+            return (layer ? (uint32_t)layer->m_added.size() : 0);
+        }
+        uint32_t getBannedNum(const uint32_t len) const {
+            const Layer* const layer = getLayer(len);
+            return (layer ? layer->m_banned.count() : 0);
+        }
+        uint32_t getAddedNum() const {
+            uint32_t num = 0;
+            for (uint32_t len = 0; len < m_layers.size(); ++len) {
+                num += getAddedNum(len);
+            }
+            return num;
+        }
+        uint32_t getBannedNum() const {
+            uint32_t num = 0;
+            for (uint32_t len = 0; len < m_layers.size(); ++len) {
+                num += getBannedNum(len);
+            }
+            return num;
+        }
+
+    private:
+
+        // (word length -> layer) table, NULL for untouched lengths
+        std::vector<Layer*> m_layers;
+        uint32_t m_layersNum;
+    };
+}
+
+#endif
@@ -0,0 +1,98 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __PACKED_ARRAY_H
+#define __PACKED_ARRAY_H
+
+#include <vector>
+
+#include "common.h"
+
+namespace crucio
+{
+    // read-only view of contiguous elements, valid as long as the
+    // owning array is left untouched
+    template <typename T>
+    class PackedRange
+    {
+    public:
+        typedef const T* const_iterator;
+
+        PackedRange(const T* const first, const T* const last) :
+            m_first(first),
+            m_last(last) {
+        }
+
+        const_iterator begin() const {
+            return m_first;
+        }
+        const_iterator end() const {
+            return m_last;
+        }
+        uint32_t size() const {
+            return (uint32_t)(m_last - m_first);
+        }
+        bool empty() const {
+            return (m_first == m_last);
+        }
+        const T& operator[](const uint32_t i) const {
+            return m_first[i];
+        }
+        const T& front() const {
+            return *m_first;
+        }
+
+    private:
+        const T* m_first;
+        const T* m_last;
+    };
+
+    // compressed sparse rows: all rows packed in one array, row r spans
+    // [m_offsets[r], m_offsets[r + 1]); rows are appended in order and
+    // never modified afterwards
+    template <typename T>
+    class PackedArray
+    {
+    public:
+        PackedArray() :
+            m_offsets(1, 0),
+            m_elements() {
+        }
+
+        void reserve(const uint32_t rows, const uint32_t elements) {
+            m_offsets.reserve(rows + 1);
+            m_elements.reserve(elements);
+        }
+
+        // appends to the open row, closeRow() opens the next one
+        void push(const T& element) {
+            m_elements.push_back(element);
+        }
+        void closeRow() {
+            m_offsets.push_back((uint32_t)m_elements.size());
+        }
+
+        uint32_t getRowsNum() const {
+            return (uint32_t)m_offsets.size() - 1;
+        }
+        uint32_t getElementsNum() const {
+            return (uint32_t)m_elements.size();
+        }
+
+        PackedRange<T> operator[](const uint32_t r) const {
+            if (m_elements.empty()) {
+                return PackedRange<T>(NULL, NULL);
+            }
+            const T* const base = &m_elements[0];
+            return PackedRange<T>(base + m_offsets[r], base + m_offsets[r + 1]);
+        }
+
+    private:
+        std::vector<uint32_t> m_offsets;
+        std::vector<T> m_elements;
+    };
+}
+
+#endif
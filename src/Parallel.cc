@@ -0,0 +1,161 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifdef CRUCIO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include <vector>
+
+#include "Parallel.h"
+
+using namespace crucio;
+using namespace std;
+
+#ifdef CRUCIO_THREADS
+// shared by workers, next index under lock
+class ParallelQueue
+{
+public:
+    ParallelQueue(const uint32_t jobsNum, ParallelJob job,
+                  void* const context) :
+        m_jobsNum(jobsNum),
+        m_job(job),
+        m_context(context),
+        m_next(0) {
+        pthread_mutex_init(&m_lock, NULL);
+    }
+    ~ParallelQueue() {
+        pthread_mutex_destroy(&m_lock);
+    }
+
+    // runs jobs until none is left
+    void drain() {
+        uint32_t i;
+        while ((i = take()) < m_jobsNum) {
+            m_job(i, m_context);
+        }
+    }
+
+private:
+    const uint32_t m_jobsNum;
+    ParallelJob m_job;
+    void* const m_context;
+    uint32_t m_next;
+    pthread_mutex_t m_lock;
+
+    uint32_t take() {
+        pthread_mutex_lock(&m_lock);
+        const uint32_t i = m_next;
+        if (m_next < m_jobsNum) {
+            ++m_next;
+        }
+        pthread_mutex_unlock(&m_lock);
+        return i;
+    }
+};
+
+static void* parallelWorker(void* const queue)
+{
+    ((ParallelQueue*) queue)->drain();
+    return NULL;
+}
+#endif
+
+uint32_t crucio::getParallelThreads()
+{
+#ifdef CRUCIO_THREADS
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    return (online > 1 ? (uint32_t) online : 1);
+#else
+    return 1;
+#endif
+}
+
+void crucio::runParallel(const uint32_t jobsNum, ParallelJob job,
+                         void* const context, const uint32_t threadsNum)
+{
+#ifdef CRUCIO_THREADS
+    uint32_t workersNum = (threadsNum > 0 ? threadsNum : getParallelThreads());
+    workersNum = min(workersNum, jobsNum);
+
+    if (workersNum > 1) {
+        ParallelQueue queue(jobsNum, job, context);
+
+        // current thread is a worker too, failed spawns just mean fewer
+        vector<pthread_t> workers(workersNum - 1);
+        vector<bool> spawned(workersNum - 1, false);
+        uint32_t wi;
+        for (wi = 0; wi < workers.size(); ++wi) {
+            spawned[wi] = (pthread_create(&workers[wi], NULL,
+                                          parallelWorker, &queue) == 0);
+        }
+        queue.drain();
+        for (wi = 0; wi < workers.size(); ++wi) {
+            if (spawned[wi]) {
+                pthread_join(workers[wi], NULL);
+            }
+        }
+        return;
+    }
+#endif
+
+    for (uint32_t i = 0; i < jobsNum; ++i) {
+        job(i, context);
+    }
+}
+
+ParallelTask::ParallelTask() :
+    m_started(false)
+#ifdef CRUCIO_THREADS
+    , m_spawned(false),
+    m_thread(),
+    m_job(NULL),
+    m_context(NULL)
+#endif
+{
+}
+
+ParallelTask::~ParallelTask()
+{
+    join();
+}
+
+void ParallelTask::start(ParallelJob job, void* const context)
+{
+    assert(!m_started);
+    m_started = true;
+
+#ifdef CRUCIO_THREADS
+    m_job = job;
+    m_context = context;
+    m_spawned = (pthread_create(&m_thread, NULL, run, this) == 0);
+    if (m_spawned) {
+        return;
+    }
+#endif
+
+    job(0, context);
+}
+
+void ParallelTask::join()
+{
+#ifdef CRUCIO_THREADS
+    if (m_spawned) {
+        pthread_join(m_thread, NULL);
+        m_spawned = false;
+    }
+#endif
+    m_started = false;
+}
+
+#ifdef CRUCIO_THREADS
+void* ParallelTask::run(void* const task)
+{
+    ParallelTask* const self = (ParallelTask*) task;
+    self->m_job(0, self->m_context);
+    return NULL;
+}
+#endif
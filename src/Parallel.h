@@ -0,0 +1,63 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __PARALLEL_H
+#define __PARALLEL_H
+
+#ifdef CRUCIO_THREADS
+#include <pthread.h>
+#endif
+
+#include "common.h"
+
+namespace crucio
+{
+    // job body, called once per index with a shared context; must not
+    // throw, exceptions can't cross threads
+    typedef void (*ParallelJob)(const uint32_t i, void* const context);
+
+    // online processors, 1 unless built with CRUCIO_THREADS
+    uint32_t getParallelThreads();
+
+    // runs job for every index in [0, jobsNum) on up to threadsNum
+    // workers (0 = all processors), indexes are handed out in order;
+    // plain loop without CRUCIO_THREADS
+    void runParallel(const uint32_t jobsNum, ParallelJob job,
+                     void* const context, const uint32_t threadsNum = 0);
+
+    // single job (index 0) left running in the background until join();
+    // runs in place on start() without CRUCIO_THREADS or if the thread
+    // can't be spawned
+    class ParallelTask
+    {
+    public:
+        ParallelTask();
+        ~ParallelTask();
+
+        void start(ParallelJob job, void* const context);
+        void join();
+
+        bool isStarted() const {
+            return m_started;
+        }
+
+    private:
+        bool m_started;
+#ifdef CRUCIO_THREADS
+        bool m_spawned;
+        pthread_t m_thread;
+        ParallelJob m_job;
+        void* m_context;
+
+        static void* run(void* const task);
+#endif
+
+        // non copyable
+        ParallelTask(const ParallelTask&);
+        ParallelTask& operator=(const ParallelTask&);
+    };
+}
+
+#endif
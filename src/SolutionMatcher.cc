@@ -45,16 +45,31 @@ bool SolutionMatcher::getMatchings(WordSetIndex* const wsIndex,
     return true;
 }
 
+// consistent with getMatchings(), that keeps current result
+uint32_t SolutionMatcher::countMatchings(WordSetIndex* const wsIndex,
+        const Word* const word,
+        const uint32_t limit)
+{
+    return min(word->getMatchingResult()->getSize(), limit);
+}
+
+bool SolutionMatcher::supportsLength(const WordSetIndex* const wsIndex,
+                                     const uint32_t len) const
+{
+    // custom words have any length
+    return true;
+}
+
 bool SolutionMatcher::getPossible(WordSetIndex* const wsIndex,
                                   Word* const word)
 {
     const string& pattern = word->get();
     const MatchingResult* const res = word->getMatchings();
     vector<ABMask>& possibleVector = word->getAllowed();
-    const set<uint32_t>& exclusions = word->getExclusions();
+    const IDBitmap& exclusions = word->getExclusions();
 
     // fixed length for words in matching result
-    const Alphabet alphabet = wsIndex->getAlphabet();
+    const SymbolTable& symbols = wsIndex->getSymbols();
     const uint32_t len = res->getWordsLength();
 
     // character position in a word or pattern
@@ -62,12 +77,12 @@ bool SolutionMatcher::getPossible(WordSetIndex* const wsIndex,
 
     *crucio_vout << "\tword " << *word->getDefinition() <<
                  " pattern: " << word->get() << " (" <<
-                 exclusions.size() << " exclusions)" << endl;
+                 exclusions.count() << " exclusions)" << endl;
 
     // start from full letter masks
     for (pos = 0; pos < len; ++pos) {
         ABMask* const possible = &possibleVector[pos];
-        setAnyMask(alphabet, possible);
+        *possible = symbols.getFullMask();
     }
     
     // only check words with a single missing character
@@ -78,11 +93,10 @@ bool SolutionMatcher::getPossible(WordSetIndex* const wsIndex,
     }
 
     // filter out through exclusions
-    set<uint32_t>::const_iterator xIt;
-    for (xIt = exclusions.begin(); xIt != exclusions.end(); ++xIt) {
+    uint32_t wi;
+    for (wi = exclusions.getNext(0); wi != UINT_MAX; wi = exclusions.getNext(wi + 1)) {
 
         // current excluded word
-        const uint32_t wi = *xIt;
         const string& xword = getCustomWord(wi);
 
         // ignore unmatching exclusions
@@ -105,14 +119,14 @@ bool SolutionMatcher::getPossible(WordSetIndex* const wsIndex,
             }
 
             *crucio_vout << "\t\t\tBEFORE: domain[" << pos << "] = " <<
-                         ABMaskString(alphabet, *possible) << endl;
+                         symbols.getMaskString(*possible) << endl;
 
             const char xch = xword.at(pos);
-            const uint32_t xi = character2Index(alphabet, xch);
+            const uint32_t xi = symbols.getIndex(xch);
             possible->reset(xi);
 
             *crucio_vout << "\t\t\tAFTER:  domain[" << pos << "] = " <<
-                         ABMaskString(alphabet, *possible) << endl;
+                         symbols.getMaskString(*possible) << endl;
         }
     }
 
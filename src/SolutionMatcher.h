@@ -22,9 +22,16 @@ namespace crucio
         virtual bool getMatchings(WordSetIndex* const wsIndex,
                                   Word* const word);
 
+        virtual uint32_t countMatchings(WordSetIndex* const wsIndex,
+                                        const Word* const word,
+                                        const uint32_t limit);
+
         virtual bool getPossible(WordSetIndex* const wsIndex,
                                  Word* const word);
 
+        virtual bool supportsLength(const WordSetIndex* const wsIndex,
+                                    const uint32_t len) const;
+
         virtual uint32_t addCustomWord(const std::string& word);
         virtual const std::string& getCustomWord(const uint32_t id) const;
         virtual uint32_t getCustomWordID(const std::string& word) const;
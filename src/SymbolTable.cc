@@ -0,0 +1,188 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "SymbolTable.h"
+
+using namespace crucio;
+using namespace std;
+
+// ISO-8859-1 letters 0xC0-0xFF without diacritics (0 = no base letter)
+static const char LATIN1_BASES[] =
+    "AAAAAA\0CEEEEIIII" // 0xC0 (ae ligature)
+    "DNOOOOO\0OUUUUY\0\0" // 0xD0 (multiplication sign, thorn, sharp s)
+    "aaaaaa\0ceeeeiiii" // 0xE0 (ae ligature)
+    "dnooooo\0ouuuuy\0y"; // 0xF0 (division sign, thorn)
+
+static const char DIRECTIVE = '!';
+static const char COMMENT = '#';
+
+SymbolTable::SymbolTable(const Alphabet alphabet)
+{
+    clear();
+
+    const uint32_t size = alphabetSize(alphabet);
+    for (uint32_t i = 0; i < size; ++i) {
+        addSymbol((char)(alphabet + i));
+    }
+    if (alphabet == LETTERS) {
+        foldCase();
+    }
+}
+
+SymbolTable::SymbolTable(const string& filename)
+{
+    clear();
+
+    ifstream in(filename.c_str());
+    if (!in.is_open()) {
+        throw DictionaryException("unable to open alphabet file");
+    }
+
+    // folding is applied after all symbols are known
+    bool caseFolding = false;
+    bool diacriticsFolding = false;
+
+    string line;
+    while (getline(in, line)) {
+        if (!line.empty() && (line[line.size() - 1] == '\r')) {
+            line.erase(line.size() - 1);
+        }
+
+        istringstream tokens(line);
+        string token;
+        while (tokens >> token) {
+            if (token[0] == COMMENT) {
+                break;
+            }
+
+            if (token[0] == DIRECTIVE) {
+                if (token == "!case") {
+                    caseFolding = true;
+                } else if (token == "!diacritics") {
+                    diacriticsFolding = true;
+                } else {
+                    throw DictionaryException("unknown alphabet directive");
+                }
+                continue;
+            }
+
+            // symbol followed by its variants
+            addSymbol(token[0]);
+            for (string::size_type i = 1; i < token.size(); ++i) {
+                addVariant(token[i], token[0]);
+            }
+        }
+    }
+
+    if (m_size == 0) {
+        throw DictionaryException("empty alphabet");
+    }
+    if (caseFolding) {
+        foldCase();
+    }
+    if (diacriticsFolding) {
+        foldDiacritics();
+    }
+}
+
+bool SymbolTable::normalize(string* const word) const
+{
+    string::iterator chI;
+    for (chI = word->begin(); chI != word->end(); ++chI) {
+        const uint32_t i = getIndex(*chI);
+        if (i == NONE) {
+            return false;
+        }
+        *chI = m_symbols[i];
+    }
+    return true;
+}
+
+string SymbolTable::getMaskString(const ABMask mask) const
+{
+    string s = "";
+
+    s += "{";
+    ABMask::Bits bits = mask.bits();
+    while (bits) {
+        s += m_symbols[firstBit(bits)];
+
+        // clears lowest set bit
+        bits &= bits - 1;
+    }
+    s += "}";
+
+    return s;
+}
+
+void SymbolTable::clear()
+{
+    m_size = 0;
+    memset(m_symbols, 0, sizeof(m_symbols));
+    memset(m_indexes, NONE, sizeof(m_indexes));
+}
+
+void SymbolTable::addSymbol(const char ch)
+{
+    // reserved grid characters and separators
+    if ((ch == ANY_CHAR) || (ch == '#') || (ch == '\0') || isspace((unsigned char) ch)) {
+        throw DictionaryException("illegal alphabet symbol");
+    }
+    if (contains(ch)) {
+        throw DictionaryException("duplicate alphabet symbol");
+    }
+    if (m_size == MAX_ALPHABET_COUNT) {
+        throw DictionaryException("alphabet too large");
+    }
+
+    m_symbols[m_size] = ch;
+    m_indexes[(unsigned char) ch] = (unsigned char) m_size;
+    ++m_size;
+}
+
+void SymbolTable::addVariant(const char variant, const char ch)
+{
+    if (contains(variant)) {
+        throw DictionaryException("duplicate alphabet symbol");
+    }
+    m_indexes[(unsigned char) variant] = m_indexes[(unsigned char) ch];
+}
+
+void SymbolTable::foldCase()
+{
+    for (uint32_t i = 0; i < m_size; ++i) {
+        const unsigned char ch = (unsigned char) m_symbols[i];
+        unsigned char lower = 0;
+
+        // ASCII and ISO-8859-1 uppercase letters
+        if ((ch >= 'A') && (ch <= 'Z')) {
+            lower = ch + 32;
+        } else if ((ch >= 0xC0) && (ch <= 0xDE) && (ch != 0xD7)) {
+            lower = ch + 32;
+        }
+
+        // explicit entries win
+        if (lower && !contains((char) lower)) {
+            m_indexes[lower] = (unsigned char) i;
+        }
+    }
+}
+
+void SymbolTable::foldDiacritics()
+{
+    for (uint32_t ch = 0xC0; ch <= 0xFF; ++ch) {
+        const char base = LATIN1_BASES[ch - 0xC0];
+
+        // explicit entries win
+        if (base && !contains((char) ch) && contains(base)) {
+            m_indexes[ch] = m_indexes[(unsigned char) base];
+        }
+    }
+}
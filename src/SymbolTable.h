@@ -0,0 +1,80 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __SYMBOL_TABLE_H
+#define __SYMBOL_TABLE_H
+
+#include <string>
+
+#include "common.h"
+
+namespace crucio
+{
+    // maps bytes to alphabet indexes and back; several bytes (e.g. lowercase
+    // or accented variants in a single-byte encoding like ISO-8859-1) may
+    // fold into the same symbol, which is the only form words are stored in
+    class SymbolTable
+    {
+    public:
+
+        // unmapped byte
+        static const uint32_t NONE = 0xFF;
+
+        // built-in alphabet (letters fold lowercase to uppercase)
+        explicit SymbolTable(const Alphabet alphabet = LETTERS);
+
+        // alphabet definition file
+        explicit SymbolTable(const std::string& filename);
+
+        // alphabet/domain size
+        uint32_t getSize() const {
+            return m_size;
+        }
+
+        // totally active mask
+        ABMask getFullMask() const {
+            return ABMask::full(m_size);
+        }
+
+        // maps i to i-th symbol of alphabet
+        char getSymbol(const uint32_t i) const {
+            return m_symbols[i];
+        }
+
+        // maps ch (or any variant of it) to its alphabet index
+        uint32_t getIndex(const char ch) const {
+            return m_indexes[(unsigned char) ch];
+        }
+        bool contains(const char ch) const {
+            return (getIndex(ch) != NONE);
+        }
+
+        // maps ch to its symbol, 0 if unmapped
+        char fold(const char ch) const {
+            const uint32_t i = getIndex(ch);
+            return ((i != NONE) ? m_symbols[i] : '\0');
+        }
+
+        // replaces every byte with its symbol, false on unmapped bytes
+        bool normalize(std::string* const word) const;
+
+        // ABMask string representation
+        std::string getMaskString(const ABMask mask) const;
+
+    private:
+        uint32_t m_size;
+        char m_symbols[MAX_ALPHABET_COUNT];
+        unsigned char m_indexes[256];
+
+        // table construction
+        void clear();
+        void addSymbol(const char ch);
+        void addVariant(const char variant, const char ch);
+        void foldCase();
+        void foldDiacritics();
+    };
+}
+
+#endif
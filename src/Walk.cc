@@ -24,23 +24,123 @@ void Walk::getReverseOrder(const vector<uint32_t>& order,
     }
 }
 
+void Walk::getLettersGraph(const Model& m,
+                           vector<vector<uint32_t> >* const graph)
+{
+    const uint32_t lettersNum = m.getLettersNum();
+
+    graph->assign(lettersNum, vector<uint32_t>());
+    for (uint32_t li = 0; li < lettersNum; ++li) {
+        const PackedRange<pair<uint32_t, LetterPosition> > neighbours =
+            m.getLetterNeighbours(li);
+
+        PackedRange<pair<uint32_t, LetterPosition> >::const_iterator nbIt;
+        for (nbIt = neighbours.begin(); nbIt != neighbours.end(); ++nbIt) {
+            (*graph)[li].push_back(nbIt->first);
+        }
+    }
+}
+
+void Walk::getWordsGraph(const Model& m,
+                         vector<vector<uint32_t> >* const graph)
+{
+    const uint32_t wordsNum = m.getWordsNum();
+
+    graph->assign(wordsNum, vector<uint32_t>());
+    for (uint32_t wi = 0; wi < wordsNum; ++wi) {
+        const PackedRange<pair<uint32_t, WordCrossing> > neighbours =
+            m.getWordNeighbours(wi);
+
+        PackedRange<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
+        for (nbIt = neighbours.begin(); nbIt != neighbours.end(); ++nbIt) {
+            (*graph)[wi].push_back(nbIt->first);
+        }
+    }
+}
+
+uint32_t Walk::getBandwidth(const vector<vector<uint32_t> >& graph,
+                            const vector<uint32_t>& order)
+{
+    vector<uint32_t> revOrder;
+    getReverseOrder(order, &revOrder);
+
+    uint32_t bandwidth = 0;
+    for (uint32_t vi = 0; vi < graph.size(); ++vi) {
+        vector<uint32_t>::const_iterator nbIt;
+        for (nbIt = graph[vi].begin(); nbIt != graph[vi].end(); ++nbIt) {
+            if (revOrder[*nbIt] > revOrder[vi]) {
+                bandwidth = max(bandwidth, revOrder[*nbIt] - revOrder[vi]);
+            }
+        }
+    }
+    return bandwidth;
+}
+
+// stable, components ranked by their first variable in order
+void Walk::groupByComponents(const vector<uint32_t>& components,
+                             vector<uint32_t>* const order)
+{
+    map<uint32_t, uint32_t> ranks;
+    vector<vector<uint32_t> > groups;
+
+    vector<uint32_t>::const_iterator oIt;
+    for (oIt = order->begin(); oIt != order->end(); ++oIt) {
+        const pair<map<uint32_t, uint32_t>::iterator, bool> res =
+            ranks.insert(make_pair(components[*oIt], (uint32_t)groups.size()));
+        if (res.second) {
+            groups.push_back(vector<uint32_t>());
+        }
+        groups[res.first->second].push_back(*oIt);
+    }
+
+    // single component, nothing to move
+    if (groups.size() < 2) {
+        return;
+    }
+
+    order->clear();
+    vector<vector<uint32_t> >::const_iterator gIt;
+    for (gIt = groups.begin(); gIt != groups.end(); ++gIt) {
+        order->insert(order->end(), gIt->begin(), gIt->end());
+    }
+}
+
 /* BFSWalk */
 
 void BFSWalk::visitLetters(const Model& m, vector<uint32_t>* const order) const
 {
-    const Cell* const root = m.getGrid()->getFirstNonBlackCell();
+    const Grid* const g = m.getGrid();
+    uint32_t i, j;
 
     // reserves enough space for order vector
     order->clear();
     order->reserve(m.getLettersNum());
 
+    // a visit per grid region, roots in grid order
+    set<const Cell*, CellCompare> visited;
+    for (i = 0; i < g->getRows(); ++i) {
+        for (j = 0; j < g->getColumns(); ++j) {
+            const Cell* const root = g->getCell(i, j);
+            if (!root->isBlack() && (visited.find(root) == visited.end())) {
+                visitLettersFrom(m, root, order, &visited);
+            }
+        }
+    }
+
+    // independent subproblems one after another
+    groupByComponents(m.getLettersComponents(), order);
+}
+
+void BFSWalk::visitLettersFrom(const Model& m,
+                               const Cell* const root, vector<uint32_t>* const order,
+                               set<const Cell*, CellCompare>* const visited)
+{
     // data structures
     queue<const Cell*> toVisit;
-    set<const Cell*, CellCompare> visited;
 
     // adds root cell
     toVisit.push(root);
-    visited.insert(root);
+    visited->insert(root);
 
     // bfs algorithm
     while (!toVisit.empty()) {
@@ -65,7 +165,7 @@ void BFSWalk::visitLetters(const Model& m, vector<uint32_t>* const order) const
             // checks for cell not to have been visited already
             const pair<set<const Cell*,
                   CellCompare>::iterator, bool> res =
-                      visited.insert(adjCl);
+                      visited->insert(adjCl);
             if (res.second) {
 
                 // cell can now be put into the queue
@@ -77,19 +177,45 @@ void BFSWalk::visitLetters(const Model& m, vector<uint32_t>* const order) const
 
 void BFSWalk::visitWords(const Model& m, vector<uint32_t>* const order) const
 {
-    const Definition* const root = m.getGrid()->getFirstDefinition();
+    const Grid* const g = m.getGrid();
+    uint32_t i, j;
 
     // reserves enough space for order vector
     order->clear();
     order->reserve(m.getWordsNum());
 
+    // a visit per grid region, roots in grid order
+    set<const Definition*, DefinitionCompare> visited;
+    for (i = 0; i < g->getRows(); ++i) {
+        for (j = 0; j < g->getColumns(); ++j) {
+            const Cell* const cl = g->getCell(i, j);
+            const Definition* const roots[] = {
+                cl->getAcrossDef(), cl->getDownDef()
+            };
+
+            // across first as in Grid::getFirstDefinition()
+            for (uint32_t ri = 0; ri < 2; ++ri) {
+                if (roots[ri] && (visited.find(roots[ri]) == visited.end())) {
+                    visitWordsFrom(m, roots[ri], order, &visited);
+                }
+            }
+        }
+    }
+
+    // independent subproblems one after another
+    groupByComponents(m.getWordsComponents(), order);
+}
+
+void BFSWalk::visitWordsFrom(const Model& m,
+                             const Definition* const root, vector<uint32_t>* const order,
+                             set<const Definition*, DefinitionCompare>* const visited)
+{
     // data structures
     queue<const Definition*> toVisit;
-    set<const Definition*, DefinitionCompare> visited;
 
     // adds root definition
     toVisit.push(root);
-    visited.insert(root);
+    visited->insert(root);
 
     // bfs algorithm
     while (!toVisit.empty()) {
@@ -118,7 +244,7 @@ void BFSWalk::visitWords(const Model& m, vector<uint32_t>* const order) const
             // checks for definition not to have been visited already
             const pair<set<const Definition*,
                   DefinitionCompare>::iterator, bool> res =
-                      visited.insert(adjDef);
+                      visited->insert(adjDef);
             if (res.second) {
 
                 // definition can now be put into the queue
@@ -132,28 +258,55 @@ void BFSWalk::visitWords(const Model& m, vector<uint32_t>* const order) const
 
 void DFSWalk::visitLetters(const Model& m, vector<uint32_t>* const order) const
 {
-    const Cell* const root = m.getGrid()->getFirstNonBlackCell();
+    const Grid* const g = m.getGrid();
+    uint32_t i, j;
 
     // reserves enough space for order vector
     order->clear();
     order->reserve(m.getLettersNum());
 
-    // starts recursive dfs
+    // starts recursive dfs per grid region, roots in grid order
     set<const Cell*, CellCompare> visited;
-    recursiveVisitLetters(m, root, order, &visited);
+    for (i = 0; i < g->getRows(); ++i) {
+        for (j = 0; j < g->getColumns(); ++j) {
+            const Cell* const root = g->getCell(i, j);
+            if (!root->isBlack()) {
+                recursiveVisitLetters(m, root, order, &visited);
+            }
+        }
+    }
+
+    // independent subproblems one after another
+    groupByComponents(m.getLettersComponents(), order);
 }
 
 void DFSWalk::visitWords(const Model& m, vector<uint32_t>* const order) const
 {
-    const Definition* const root = m.getGrid()->getFirstDefinition();
+    const Grid* const g = m.getGrid();
+    uint32_t i, j;
 
     // reserves enough space for order vector
     order->clear();
     order->reserve(m.getWordsNum());
 
-    // starts recursive dfs
+    // starts recursive dfs per grid region, roots in grid order
     set<const Definition*, DefinitionCompare> visited;
-    recursiveVisitWords(m, root, order, &visited);
+    for (i = 0; i < g->getRows(); ++i) {
+        for (j = 0; j < g->getColumns(); ++j) {
+            const Cell* const cl = g->getCell(i, j);
+
+            // across first as in Grid::getFirstDefinition()
+            if (cl->getAcrossDef()) {
+                recursiveVisitWords(m, cl->getAcrossDef(), order, &visited);
+            }
+            if (cl->getDownDef()) {
+                recursiveVisitWords(m, cl->getDownDef(), order, &visited);
+            }
+        }
+    }
+
+    // independent subproblems one after another
+    groupByComponents(m.getWordsComponents(), order);
 }
 
 void DFSWalk::recursiveVisitLetters(const Model& m,
@@ -212,3 +365,187 @@ void DFSWalk::recursiveVisitWords(const Model& m,
         recursiveVisitWords(m, adjDef, order, visited);
     }
 }
+
+
+/* RCMWalk */
+
+void RCMWalk::visitLetters(const Model& m, vector<uint32_t>* const order) const
+{
+    vector<vector<uint32_t> > graph;
+    getLettersGraph(m, &graph);
+    visit(graph, order);
+
+    // independent subproblems one after another
+    groupByComponents(m.getLettersComponents(), order);
+}
+
+void RCMWalk::visitWords(const Model& m, vector<uint32_t>* const order) const
+{
+    vector<vector<uint32_t> > graph;
+    getWordsGraph(m, &graph);
+    visit(graph, order);
+
+    // independent subproblems one after another
+    groupByComponents(m.getWordsComponents(), order);
+}
+
+void RCMWalk::visit(const vector<vector<uint32_t> >& graph,
+                    vector<uint32_t>* const order)
+{
+    const uint32_t varsNum = (uint32_t)graph.size();
+    const DegreeCompare byDegree(graph);
+
+    // BFS distances, reset after each use
+    vector<uint32_t> dist(varsNum, UINT_MAX);
+    vector<bool> visited(varsNum, false);
+    vector<uint32_t> adjacencies;
+
+    order->clear();
+    order->reserve(varsNum);
+
+    // a BFS per connected part
+    for (uint32_t vi = 0; vi < varsNum; ++vi) {
+        if (visited[vi]) {
+            continue;
+        }
+
+        // starts far from the center
+        uint32_t qi = (uint32_t)order->size();
+        const uint32_t root = getPeripheral(graph, vi, &dist);
+        visited[root] = true;
+        order->push_back(root);
+
+        // order vector is the queue, lower degrees first
+        for (; qi < order->size(); ++qi) {
+            const vector<uint32_t>& nbs = graph[(*order)[qi]];
+
+            adjacencies.clear();
+            vector<uint32_t>::const_iterator nbIt;
+            for (nbIt = nbs.begin(); nbIt != nbs.end(); ++nbIt) {
+                if (!visited[*nbIt]) {
+                    visited[*nbIt] = true;
+                    adjacencies.push_back(*nbIt);
+                }
+            }
+            sort(adjacencies.begin(), adjacencies.end(), byDegree);
+            order->insert(order->end(), adjacencies.begin(), adjacencies.end());
+        }
+    }
+
+    // reversal never widens the profile
+    reverse(order->begin(), order->end());
+}
+
+// pseudo-peripheral variable (George-Liu), the lowest degree one of the
+// farthest BFS level, until eccentricity stops growing
+uint32_t RCMWalk::getPeripheral(const vector<vector<uint32_t> >& graph,
+                                const uint32_t start,
+                                vector<uint32_t>* const dist)
+{
+    uint32_t root = start;
+    uint32_t eccentricity = 0;
+    vector<uint32_t> levels;
+
+    while (true) {
+        levels.clear();
+        levels.push_back(root);
+        (*dist)[root] = 0;
+        for (uint32_t qi = 0; qi < levels.size(); ++qi) {
+            const uint32_t vi = levels[qi];
+            const vector<uint32_t>& nbs = graph[vi];
+
+            vector<uint32_t>::const_iterator nbIt;
+            for (nbIt = nbs.begin(); nbIt != nbs.end(); ++nbIt) {
+                if ((*dist)[*nbIt] == UINT_MAX) {
+                    (*dist)[*nbIt] = (*dist)[vi] + 1;
+                    levels.push_back(*nbIt);
+                }
+            }
+        }
+
+        // lowest degree in last level
+        const uint32_t farthest = (*dist)[levels.back()];
+        uint32_t next = levels.back();
+        vector<uint32_t>::const_reverse_iterator lIt;
+        for (lIt = levels.rbegin(); (lIt != levels.rend()) &&
+                ((*dist)[*lIt] == farthest); ++lIt) {
+            if (graph[*lIt].size() < graph[next].size()) {
+                next = *lIt;
+            }
+        }
+
+        // clears touched distances only
+        vector<uint32_t>::const_iterator vIt;
+        for (vIt = levels.begin(); vIt != levels.end(); ++vIt) {
+            (*dist)[*vIt] = UINT_MAX;
+        }
+
+        if (farthest <= eccentricity) {
+            break;
+        }
+        eccentricity = farthest;
+        root = next;
+    }
+
+    return root;
+}
+
+/* MinWidthWalk */
+
+void MinWidthWalk::visitLetters(const Model& m, vector<uint32_t>* const order) const
+{
+    vector<vector<uint32_t> > graph;
+    getLettersGraph(m, &graph);
+    visit(graph, order);
+
+    // independent subproblems one after another
+    groupByComponents(m.getLettersComponents(), order);
+}
+
+void MinWidthWalk::visitWords(const Model& m, vector<uint32_t>* const order) const
+{
+    vector<vector<uint32_t> > graph;
+    getWordsGraph(m, &graph);
+    visit(graph, order);
+
+    // independent subproblems one after another
+    groupByComponents(m.getWordsComponents(), order);
+}
+
+// fills order backwards, each time removing a minimum degree variable
+// from the remaining graph
+void MinWidthWalk::visit(const vector<vector<uint32_t> >& graph,
+                         vector<uint32_t>* const order)
+{
+    const uint32_t varsNum = (uint32_t)graph.size();
+    uint32_t vi;
+
+    // <remaining degree, variable> queue
+    vector<uint32_t> degrees(varsNum);
+    vector<bool> removed(varsNum, false);
+    set<pair<uint32_t, uint32_t> > byDegree;
+    for (vi = 0; vi < varsNum; ++vi) {
+        degrees[vi] = (uint32_t)graph[vi].size();
+        byDegree.insert(make_pair(degrees[vi], vi));
+    }
+
+    order->resize(varsNum);
+    uint32_t pos = varsNum;
+    while (!byDegree.empty()) {
+        vi = byDegree.begin()->second;
+        byDegree.erase(byDegree.begin());
+        removed[vi] = true;
+        (*order)[--pos] = vi;
+
+        // neighbours lose an edge
+        const vector<uint32_t>& nbs = graph[vi];
+        vector<uint32_t>::const_iterator nbIt;
+        for (nbIt = nbs.begin(); nbIt != nbs.end(); ++nbIt) {
+            if (!removed[*nbIt]) {
+                byDegree.erase(make_pair(degrees[*nbIt], *nbIt));
+                --degrees[*nbIt];
+                byDegree.insert(make_pair(degrees[*nbIt], *nbIt));
+            }
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #ifndef __WALK_H
 #define __WALK_H
 
+#include <map>
 #include <queue>
 #include <set>
 #include <vector>
@@ -28,6 +29,22 @@ namespace crucio
                                   std::vector<uint32_t>* const) const = 0;
         virtual void visitWords(const Model&,
                                 std::vector<uint32_t>* const) const = 0;
+
+        // constraint graphs as adjacency lists
+        static void getLettersGraph(const Model&,
+                                    std::vector<std::vector<uint32_t> >* const);
+        static void getWordsGraph(const Model&,
+                                  std::vector<std::vector<uint32_t> >* const);
+
+        // max distance in order between constrained variables
+        static uint32_t getBandwidth(const std::vector<std::vector<uint32_t> >& graph,
+                                     const std::vector<uint32_t>& order);
+
+    protected:
+
+        // makes variables of the same component contiguous
+        static void groupByComponents(const std::vector<uint32_t>& components,
+                                      std::vector<uint32_t>* const order);
     };
 
 // breadth-first search
@@ -38,6 +55,14 @@ namespace crucio
                                   std::vector<uint32_t>* const) const;
         virtual void visitWords(const Model&,
                                 std::vector<uint32_t>* const) const;
+
+    private:
+        static void visitLettersFrom(const Model&,
+                                     const Cell* const, std::vector<uint32_t>* const,
+                                     std::set<const Cell*, CellCompare>* const);
+        static void visitWordsFrom(const Model&,
+                                   const Definition* const, std::vector<uint32_t>* const,
+                                   std::set<const Definition*, DefinitionCompare>* const);
     };
 
 // depth-first search
@@ -57,6 +82,56 @@ namespace crucio
                                         const Definition* const, std::vector<uint32_t>* const,
                                         std::set<const Definition*, DefinitionCompare>* const);
     };
+
+// reverse Cuthill-McKee, keeps constrained variables close in order
+    class RCMWalk : public Walk
+    {
+    public:
+        virtual void visitLetters(const Model&,
+                                  std::vector<uint32_t>* const) const;
+        virtual void visitWords(const Model&,
+                                std::vector<uint32_t>* const) const;
+
+    private:
+
+        // neighbours by increasing degree
+        class DegreeCompare
+        {
+        public:
+            DegreeCompare(const std::vector<std::vector<uint32_t> >& graph) :
+                m_graph(graph) {
+            }
+
+            bool operator()(const uint32_t v1, const uint32_t v2) const {
+                return (std::make_pair(m_graph[v1].size(), v1) <
+                        std::make_pair(m_graph[v2].size(), v2));
+            }
+
+        private:
+            const std::vector<std::vector<uint32_t> >& m_graph;
+        };
+
+        static void visit(const std::vector<std::vector<uint32_t> >&,
+                          std::vector<uint32_t>* const);
+        static uint32_t getPeripheral(const std::vector<std::vector<uint32_t> >&,
+                                      const uint32_t,
+                                      std::vector<uint32_t>* const);
+    };
+
+// minimum width, each variable has as few constrained predecessors as
+// possible
+    class MinWidthWalk : public Walk
+    {
+    public:
+        virtual void visitLetters(const Model&,
+                                  std::vector<uint32_t>* const) const;
+        virtual void visitWords(const Model&,
+                                std::vector<uint32_t>* const) const;
+
+    private:
+        static void visit(const std::vector<std::vector<uint32_t> >&,
+                          std::vector<uint32_t>* const);
+    };
 }
 
 #endif
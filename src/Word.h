@@ -12,23 +12,29 @@
 
 #include "Dictionary.h"
 #include "Grid.h"
+#include "IDBitmap.h"
 
 namespace crucio
 {
     class Word
     {
     public:
-        Word(Dictionary* const dict, const Definition* defRef) :
+        // exclusions are shared by all words having the same length;
+        // matching result is placed in arena if given, right after a
+        // word placed there too
+        Word(Dictionary* const dict, const Definition* defRef,
+             IDBitmap* const excluded, Arena* const arena = NULL) :
             m_dictionary(dict),
             m_defRef(defRef),
             m_mask(defRef->getLength(), ANY_CHAR),
             m_wildcards(defRef->getLength()),
-            m_letterMasks(defRef->getLength(), anyMask(dict->getAlphabet())),
-            m_matchings(dict->createMatchingResult(defRef->getLength())),
-            m_excluded() {
+            m_letterMasks(defRef->getLength(), dict->getSymbols().getFullMask()),
+            m_matchings(dict->createMatchingResult(defRef->getLength(), arena)),
+            m_placed(arena != NULL),
+            m_excluded(excluded) {
         }
         ~Word() {
-            m_dictionary->destroyMatchingResult(m_matchings);
+            m_dictionary->destroyMatchingResult(m_matchings, m_placed);
         }
 
         // referred definition
@@ -85,11 +91,23 @@ namespace crucio
         }
 
         // rematches pattern, updates matching result and letter masks
-        void doMatchUpdating() {
-            m_dictionary->getMatchings(this);
+        // (false if nothing matches)
+        bool doMatchUpdating() {
+            const bool matched = m_dictionary->getMatchings(this);
 
             // updates letters masks
             m_dictionary->getPossible(this);
+
+            return matched;
+        }
+
+        // pattern matchings count (up to limit) or existence, matching
+        // result is not updated
+        uint32_t countMatchings(const uint32_t limit) const {
+            return m_dictionary->countMatchings(this, limit);
+        }
+        bool anyMatch() const {
+            return m_dictionary->anyMatch(this);
         }
 
         // word id in dictionary (WARNING: only after matching a complete mask!)
@@ -112,15 +130,16 @@ namespace crucio
             return id;
         }
 
-        // exclusions management for doMatch()
-        void exclude(const int id) {
-            m_excluded.insert(id);
+        // exclusions management for doMatch(), affects every word
+        // sharing the same exclusions
+        void exclude(const uint32_t id) {
+            m_excluded->set(id);
         }
-        void include(const int id) {
-            m_excluded.erase(id);
+        void include(const uint32_t id) {
+            m_excluded->reset(id);
         }
-        const std::set<uint32_t>& getExclusions() const {
-            return m_excluded;
+        const IDBitmap& getExclusions() const {
+            return *m_excluded;
         }
 
         // current domains
@@ -157,9 +176,10 @@ namespace crucio
         uint32_t m_wildcards;
         std::vector<ABMask> m_letterMasks;
         MatchingResult* m_matchings;
+        const bool m_placed;
 
         // ID based exclusions
-        std::set<uint32_t> m_excluded;
+        IDBitmap* const m_excluded;
     };
 }
 
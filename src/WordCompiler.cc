@@ -17,7 +17,8 @@ WordCompiler::WordCompiler() :
     m_revOrder(),
     m_deps(),
     m_revDeps(),
-    m_bj()
+    m_bj(),
+    m_allDiff()
 {
 }
 
@@ -41,6 +42,12 @@ Compiler::Result WordCompiler::configure(const Walk& walk)
     // words graph visit
     walk.visitWords(*m_model, &m_order);
     Walk::getReverseOrder(m_order, &m_revOrder);
+    if (isVerbose()) {
+        vector<vector<uint32_t> > graph;
+        Walk::getWordsGraph(*m_model, &graph);
+        *crucio_vout << "words order bandwidth = " <<
+                     Walk::getBandwidth(graph, m_order) << endl;
+    }
 
     // direct and reverse dependencies
     for (wi = 0; wi < wordsNum; ++wi) {
@@ -49,9 +56,9 @@ Compiler::Result WordCompiler::configure(const Walk& walk)
 //        ordWi = m_revOrder[wi];
 
         // computes dependencies from related words
-        const list<pair<uint32_t, WordCrossing> >& neighbours =
+        const PackedRange<pair<uint32_t, WordCrossing> > neighbours =
             m_model->getWordNeighbours(wi);
-        list<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
+        PackedRange<pair<uint32_t, WordCrossing> >::const_iterator nbIt;
         for (nbIt = neighbours.begin(); nbIt != neighbours.end(); ++nbIt) {
             const uint32_t rWi = nbIt->first;
 
@@ -120,6 +127,9 @@ Compiler::Result WordCompiler::configure(const Walk& walk)
     }
     m_bj.configure(m_order, ordDeps);
 
+    // independent subproblems
+    configureComponents(m_order, m_model->getWordsComponents());
+
     // use word-based domains
     m_model->computeWordDomains();
 
@@ -143,7 +153,7 @@ Compiler::Result WordCompiler::compileFrom(const uint32_t i)
             Letter* const l = m_model->getLetter(li);
 
             // words this letter belongs to (NEVER empty)
-            const list<LetterPosition>& letterWords = m_model->getLetterWords(li);
+            const PackedRange<LetterPosition> letterWords = m_model->getLetterWords(li);
 
             // fw is the first word
             const LetterPosition& fLp = *letterWords.begin();
@@ -154,7 +164,14 @@ Compiler::Result WordCompiler::compileFrom(const uint32_t i)
             l->set(fw->getAt(fwPos));
         }
 
-        return Compiler::SUCCESS;
+        // enumeration resumes from here as from a failure
+        if (acceptSolution()) {
+            return Compiler::SUCCESS;
+        }
+#ifdef CRUCIO_BJ
+        m_bj.solution(i);
+#endif
+        return Compiler::FAILURE_IMPOSSIBLE;
     } else {
 
         // maps variable from ordering
@@ -185,6 +202,11 @@ Compiler::Result WordCompiler::compileFrom(const uint32_t i)
         // iterates over domain
         while (!domainSet.empty()) {
 
+            // search limits
+            if (isInterrupted()) {
+                return getInterruption();
+            }
+
             // chooses value to assign
             choose(wLen, &domainSet, &v);
 
@@ -200,14 +222,24 @@ Compiler::Result WordCompiler::compileFrom(const uint32_t i)
             printModelGrid(*crucio_vout, *m_model);
             *crucio_vout << endl;
 
+            // deepest partial fill, by assigned words
+            saveBest(i + 1);
+
             // recursively solved?
-            if (compileFrom(i + 1) == Compiler::SUCCESS) {
+            const Compiler::Result result = compileFrom(i + 1);
+            if (result == Compiler::SUCCESS) {
                 return Compiler::SUCCESS;
             } else {
 
                 // retires variable
                 retire(wi, oldV, &remStack);
 
+                // interrupted rather than failed, or no way out
+                if ((result != Compiler::FAILURE_IMPOSSIBLE) ||
+                        isComponentFailed()) {
+                    return result;
+                }
+
 #ifdef CRUCIO_BJ
                 // returns if there are no more jumps or last
                 // jump gets past current variable
@@ -218,15 +250,20 @@ Compiler::Result WordCompiler::compileFrom(const uint32_t i)
                 }
 #endif
             }
-
-            // timeout check
-            if (isTimeout()) {
-                return Compiler::FAILURE_TIMEOUT;
-            }
         }
 
         *crucio_vout << "word " << wi << " ... BACKTRACK!" << endl;
 
+        // backtracks are charged too
+        if (isInterruptedOnBacktrack()) {
+            return getInterruption();
+        }
+
+        // later components can't be fixed from here
+        if (failComponent(i)) {
+            return Compiler::FAILURE_IMPOSSIBLE;
+        }
+
         // algorithm fails iff first variable backtracks
         if (i > 0) {
 #ifdef CRUCIO_BJ
@@ -254,14 +291,20 @@ void WordCompiler::choose(const uint32_t wLen,
     viIt = domainSet->begin();
     vi = *viIt;
 #else
-    // random choice in matchings (TODO: a hash table would be
-    // better for domains instead of a tree set)
-    const uint32_t viPos = rand() % domainSet->size();
-    uint32_t domPos = 0;
-    viIt = domainSet->begin();
-    while (domPos < viPos) {
-        ++domPos;
-        ++viIt;
+    // random choice in best scoring matchings (TODO: a hash table would
+    // be better for domains instead of a tree set)
+    vector<set<uint32_t>::iterator> best;
+    getBestCandidates(wLen, domainSet->begin(), domainSet->end(), &best);
+    if (best.empty()) {
+        const uint32_t viPos = m_random.next((uint32_t)domainSet->size());
+        uint32_t domPos = 0;
+        viIt = domainSet->begin();
+        while (domPos < viPos) {
+            ++domPos;
+            ++viIt;
+        }
+    } else {
+        viIt = best[m_random.next((uint32_t)best.size())];
     }
     vi = *viIt;
 #endif
@@ -289,6 +332,14 @@ bool WordCompiler::assign(const uint32_t wi,
     w->set(v);
     w->doMatch();
 
+    // a deterministic solver must be able to tell completed words apart
+    if (isDeterministic() && !isDistinguishable(wi)) {
+        *crucio_vout << "\tword " << wi <<
+                     ": indistinguishable (DETERMINISTIC)" << endl;
+
+        return false;
+    }
+
     // excludes domain value from remaining words of same length
     if (isUnique()) {
 
@@ -296,13 +347,16 @@ bool WordCompiler::assign(const uint32_t wi,
         const uint32_t excludedID = w->getID();
         assert(excludedID != UINT_MAX);
 
+        // excludes domain value from all words having same length (no
+        // need for rematch)
+        w->exclude(excludedID);
+
         // selects words subset by length
-        const map<uint32_t, set<uint32_t> >& wordsByLength =
-            m_model->getWordsByLength();
-        const set<uint32_t>& subset = wordsByLength.find(wLen)->second;
+        const PackedRange<uint32_t> subset =
+            m_model->getWordsByLength(wLen);
 
-        // updates exclusion lists and recalculates domains
-        set<uint32_t>::const_iterator slWiIt;
+        // recalculates domains
+        PackedRange<uint32_t>::const_iterator slWiIt;
         for (slWiIt = subset.begin(); slWiIt != subset.end(); ++slWiIt) {
             const uint32_t slWi = *slWiIt;
 
@@ -311,17 +365,14 @@ bool WordCompiler::assign(const uint32_t wi,
                 continue;
             }
 
-            // same length word
-            Word* const slw = m_model->getWord(slWi);
-
-            // excludes domain value (no need for rematch)
+            // removes domain value
             set<uint32_t>* const slDom = &m_domains[slWi];
             const uint32_t slDomOldCount = (uint32_t)slDom->size();
-            slw->exclude(excludedID);
-            slDom->erase(excludedID);
 
             // puts removed value on the stack
-            remStack->push(make_pair(slWi, excludedID));
+            if (slDom->erase(excludedID)) {
+                remStack->push(make_pair(slWi, excludedID));
+            }
 
             if (isVerbose()) {
                 const uint32_t slDomNewCount = (uint32_t)slDom->size();
@@ -362,6 +413,14 @@ bool WordCompiler::assign(const uint32_t wi,
         // sets shared character w[pos] at dw[dPos]
         dw->setAt(dPos, w->getAt(pos));
 
+        // completed by crossings
+        if (isDeterministic() && dw->isComplete() && !isDistinguishable(dWi)) {
+            *crucio_vout << "\tword " << dWi <<
+                         ": indistinguishable (DETERMINISTIC)" << endl;
+
+            return false;
+        }
+
         // recalculates possible words
         dw->doMatch();
 
@@ -401,6 +460,22 @@ bool WordCompiler::assign(const uint32_t wi,
         }
     }
 
+    // alldifferent over the lengths whose domains just shrank
+    if (isUnique()) {
+        set<uint32_t> lengths;
+        lengths.insert(wLen);
+        for (dIt = wiRevDeps.begin(); dIt != wiRevDeps.end(); ++dIt) {
+            lengths.insert(m_model->getWord(dIt->first)->getLength());
+        }
+
+        set<uint32_t>::const_iterator lenIt;
+        for (lenIt = lengths.begin(); lenIt != lengths.end(); ++lenIt) {
+            if (!propagateUnique(wi, *lenIt, remStack, failed)) {
+                return false;
+            }
+        }
+    }
+
     return true;
 }
 
@@ -408,9 +483,19 @@ void WordCompiler::retire(const uint32_t wi,
                           const string& oldV,
                           stack<pair<uint32_t, uint32_t> >* const remStack)
 {
-    // gets word object and its length
+    // gets word object
     Word* const w = m_model->getWord(wi);
-    const uint32_t wLen = w->getLength();
+
+    // readmit domain value in same length words
+    if (isUnique()) {
+
+        // excluded word ID (must exist in dictionary)
+        const uint32_t excludedID = w->getID();
+        assert(excludedID != UINT_MAX);
+
+        // reincludes completed word in all words having same length
+        w->include(excludedID);
+    }
 
     // domains update
     const list<pair<uint32_t, WordCrossing> >& wiRevDeps = m_revDeps[wi];
@@ -422,29 +507,6 @@ void WordCompiler::retire(const uint32_t wi,
         const uint32_t dPos = dIt->second.getCPosition();
         Word* const dw = m_model->getWord(dWi);
 
-        // readmit domain value in same length words
-        if (isUnique()) {
-
-            // excluded word ID (must exist in dictionary)
-            const uint32_t excludedID = w->getID();
-            assert(excludedID != UINT_MAX);
-
-            // selects words subset by length
-            const map<uint32_t, set<uint32_t> >& wordsByLength =
-                m_model->getWordsByLength();
-            const set<uint32_t>& subset = wordsByLength.find(wLen)->second;
-
-            // updates exclusion lists
-            set<uint32_t>::const_iterator slWiIt;
-            for (slWiIt = subset.begin(); slWiIt != subset.end(); ++slWiIt) {
-                const uint32_t slWi = *slWiIt;
-                Word* const slw = m_model->getWord(slWi);
-
-                // reincludes completed word
-                slw->include(excludedID);
-            }
-        }
-
         // unsets shared character dw[dPos]
         dw->unsetAt(dPos);
     }
@@ -467,3 +529,111 @@ void WordCompiler::retire(const uint32_t wi,
         remStack->pop();
     }
 }
+
+// wi = last assigned word, len = words length to propagate
+bool WordCompiler::propagateUnique(const uint32_t wi,
+                                   const uint32_t len,
+                                   stack<pair<uint32_t, uint32_t> >* const remStack,
+                                   set<uint32_t>* const failed)
+{
+    // unassigned words having length len
+    const PackedRange<uint32_t> subset = m_model->getWordsByLength(len);
+    vector<uint32_t> slWis;
+    PackedRange<uint32_t>::const_iterator slWiIt;
+    for (slWiIt = subset.begin(); slWiIt != subset.end(); ++slWiIt) {
+        if (m_revOrder[*slWiIt] > m_revOrder[wi]) {
+            slWis.push_back(*slWiIt);
+        }
+    }
+
+    // words with at least as many candidates as words can always be
+    // matched, only the others take part in the propagation
+    const uint32_t slCount = (uint32_t)slWis.size();
+    vector<uint32_t> tightWis, looseWis;
+    vector<uint32_t>::const_iterator wIt;
+    m_allDiff.clear();
+    for (wIt = slWis.begin(); wIt != slWis.end(); ++wIt) {
+        const set<uint32_t>& slDom = m_domains[*wIt];
+        if (slDom.size() < slCount) {
+            m_allDiff.addSlot(slDom.begin(), slDom.end());
+            tightWis.push_back(*wIt);
+        } else {
+            looseWis.push_back(*wIt);
+        }
+    }
+    if (tightWis.size() < 2) {
+        return true;
+    }
+
+    // not enough distinct candidates
+    if (!m_allDiff.propagate()) {
+#ifndef CRUCIO_BJ_FAST
+        // adds failed variables orders
+        for (wIt = tightWis.begin(); wIt != tightWis.end(); ++wIt) {
+            failed->insert(m_revOrder[*wIt]);
+        }
+#endif
+        *crucio_vout << "\tAD failed at length " << len <<
+                     " (UNIQUE)" << endl;
+
+        return false;
+    }
+
+    // removes values outside of any matching
+    uint32_t i;
+    for (i = 0; i < tightWis.size(); ++i) {
+        const uint32_t slWi = tightWis[i];
+        set<uint32_t>* const slDom = &m_domains[slWi];
+        const vector<uint32_t>& removals = m_allDiff.getRemovals(i);
+
+        vector<uint32_t>::const_iterator rIt;
+        for (rIt = removals.begin(); rIt != removals.end(); ++rIt) {
+            slDom->erase(*rIt);
+            remStack->push(make_pair(slWi, *rIt));
+        }
+
+        if (isVerbose() && !removals.empty()) {
+            *crucio_vout << "\tword " << slWi << ": removed " <<
+                         removals.size() << " matchings, now " <<
+                         slDom->size() << " (AD)" << endl;
+        }
+    }
+
+    // Hall sets values are taken
+    const vector<uint32_t>& hallValues = m_allDiff.getHallValues();
+    if (hallValues.empty()) {
+        return true;
+    }
+    for (wIt = looseWis.begin(); wIt != looseWis.end(); ++wIt) {
+        const uint32_t slWi = *wIt;
+        set<uint32_t>* const slDom = &m_domains[slWi];
+        const uint32_t slDomOldCount = (uint32_t)slDom->size();
+
+        vector<uint32_t>::const_iterator hIt;
+        for (hIt = hallValues.begin(); hIt != hallValues.end(); ++hIt) {
+            if (slDom->erase(*hIt)) {
+                remStack->push(make_pair(slWi, *hIt));
+            }
+        }
+
+        if (isVerbose() && (slDom->size() < slDomOldCount)) {
+            *crucio_vout << "\tword " << slWi << ": removed " <<
+                         (slDomOldCount - slDom->size()) << " matchings, now " <<
+                         slDom->size() << " (AD)" << endl;
+        }
+
+        // an empty domain implies failure
+        if (slDom->empty()) {
+#ifndef CRUCIO_BJ_FAST
+            // adds failed variable order
+            failed->insert(m_revOrder[slWi]);
+#endif
+            *crucio_vout << "\tFC failed at " << slWi <<
+                         " (UNIQUE)" << endl;
+
+            return false;
+        }
+    }
+
+    return true;
+}
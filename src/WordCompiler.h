@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "common.h"
+#include "AllDifferent.h"
 #include "Backjumper.h"
 #include "Compiler.h"
 
@@ -38,6 +39,7 @@ namespace crucio
         std::vector<std::list<std::pair<uint32_t, WordCrossing> > > m_deps;
         std::vector<std::list<std::pair<uint32_t, WordCrossing> > > m_revDeps;
         Backjumper m_bj;
+        AllDifferent m_allDiff;
 
         // subproblems
         void choose(const uint32_t wLen,
@@ -51,6 +53,10 @@ namespace crucio
         void retire(const uint32_t wi,
                     const std::string& oldV,
                     std::stack<std::pair<uint32_t, uint32_t> >* const remStack);
+        bool propagateUnique(const uint32_t wi,
+                             const uint32_t len,
+                             std::stack<std::pair<uint32_t, uint32_t> >* const remStack,
+                             std::set<uint32_t>* const failed);
     };
 }
 
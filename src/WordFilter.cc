@@ -0,0 +1,63 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#include "WordFilter.h"
+#include "WordSet.h"
+
+using namespace crucio;
+using namespace std;
+
+WordFilter::WordFilter(const WordSetIndex* const index) :
+    m_index(index),
+    m_allowed()
+{
+}
+
+void WordFilter::allowAll(const uint32_t minScore)
+{
+    m_allowed.resize(m_index->getLengthBound());
+    for (uint32_t len = 0; len < m_allowed.size(); ++len) {
+        const WordSet* const ws = m_index->getWordSet(len);
+        if (!ws) {
+            continue;
+        }
+        // IDs ascend as scores descend
+        const uint32_t wsSize = ws->getSize();
+        for (uint32_t id = 0; (id < wsSize) && (ws->getScore(id) >= minScore); ++id) {
+            m_allowed[len].set(id);
+        }
+    }
+}
+
+bool WordFilter::allow(const string& word)
+{
+    const uint32_t id = getWordID(word);
+    if (id == UINT_MAX) {
+        return false;
+    }
+    allow((uint32_t)word.length(), id);
+    return true;
+}
+
+bool WordFilter::deny(const string& word)
+{
+    const uint32_t id = getWordID(word);
+    if (id == UINT_MAX) {
+        return false;
+    }
+    deny((uint32_t)word.length(), id);
+    return true;
+}
+
+// normalized to index symbols first
+uint32_t WordFilter::getWordID(const string& word) const
+{
+    string upperWord = word;
+    if (!m_index->getSymbols().normalize(&upperWord)) {
+        return UINT_MAX;
+    }
+    const WordSet* const ws = m_index->getWordSet((uint32_t)upperWord.length());
+    return (ws ? ws->getWordID(upperWord) : UINT_MAX);
+}
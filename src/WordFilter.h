@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2007 Davide De Rosa
+// License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
+//
+
+#ifndef __WORD_FILTER_H
+#define __WORD_FILTER_H
+
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "IDBitmap.h"
+
+namespace crucio
+{
+    class WordSetIndex;
+
+    // allowed subset of an index words, a bitmap per length; initially
+    // allows nothing, must be left untouched while a view matches on it
+    class WordFilter
+    {
+    public:
+        explicit WordFilter(const WordSetIndex* const index);
+
+        // whole index, words scoring at least minScore
+        void allowAll(const uint32_t minScore = 0);
+
+        // by word, false if not found
+        bool allow(const std::string& word);
+        bool deny(const std::string& word);
+
+        // by ID
+        void allow(const uint32_t len, const uint32_t id) {
+            if (len >= m_allowed.size()) {
+                m_allowed.resize(len + 1);
+            }
+            m_allowed[len].set(id);
+        }
+        void deny(const uint32_t len, const uint32_t id) {
+            if (len < m_allowed.size()) {
+                m_allowed[len].reset(id);
+            }
+        }
+        bool isAllowed(const uint32_t len, const uint32_t id) const {
+            return ((len < m_allowed.size()) && m_allowed[len].test(id));
+        }
+
+        // allowed IDs at length len
+        const IDBitmap& getAllowed(const uint32_t len) const {
+            static const IDBitmap none;
+
+            return (len < m_allowed.size() ? m_allowed[len] : none);
+        }
+        uint32_t getAllowedNum(const uint32_t len) const {
+            return getAllowed(len).count();
+        }
+        uint32_t getAllowedNum() const {
+            uint32_t num = 0;
+            for (uint32_t len = 0; len < m_allowed.size(); ++len) {
+                num += m_allowed[len].count();
+            }
+            return num;
+        }
+
+    private:
+        const WordSetIndex* const m_index;
+
+        // (word length -> allowed IDs) table
+        std::vector<IDBitmap> m_allowed;
+
+        uint32_t getWordID(const std::string& word) const;
+    };
+}
+
+#endif
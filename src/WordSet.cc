@@ -3,22 +3,176 @@
 // License: http://www.gnu.org/licenses/gpl.html GPL version 3 or higher
 //
 
+#include <cctype>
+#include <functional>
+
 #include "WordSet.h"
 
 using namespace crucio;
 using namespace std;
 
+/* utils */
+
+// word indexes alphabetically, best score first among equal words
+class ByWord
+{
+public:
+    ByWord(const vector<string>& words, const vector<uint32_t>& scores) :
+        m_words(words),
+        m_scores(scores) {
+    }
+
+    bool operator()(const uint32_t i1, const uint32_t i2) const {
+        const int cmp = m_words[i1].compare(m_words[i2]);
+        if (cmp != 0) {
+            return (cmp < 0);
+        }
+        return (m_scores[i1] > m_scores[i2]);
+    }
+
+private:
+    const vector<string>& m_words;
+    const vector<uint32_t>& m_scores;
+};
+
+// word indexes having the same word
+class SameWord
+{
+public:
+    explicit SameWord(const vector<string>& words) :
+        m_words(words) {
+    }
+
+    bool operator()(const uint32_t i1, const uint32_t i2) const {
+        return (m_words[i1] == m_words[i2]);
+    }
+
+private:
+    const vector<string>& m_words;
+};
+
+// word indexes by descending score
+class ByScore
+{
+public:
+    explicit ByScore(const vector<uint32_t>& scores) :
+        m_scores(scores) {
+    }
+
+    bool operator()(const uint32_t i1, const uint32_t i2) const {
+        return (m_scores[i1] > m_scores[i2]);
+    }
+
+private:
+    const vector<uint32_t>& m_scores;
+};
+
+bool crucio::parseScore(const char* first, const char* last,
+                        uint32_t* const score)
+{
+    while ((last > first) && isspace((unsigned char) *(last - 1))) {
+        --last;
+    }
+    if (first == last) {
+        return false;
+    }
+
+    uint32_t value = 0;
+    for (; first < last; ++first) {
+        if (!isdigit((unsigned char) *first)) {
+            return false;
+        }
+        const uint32_t digit = (uint32_t)(*first - '0');
+        if (value > (UINT_MAX - digit) / 10) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    *score = value;
+    return true;
+}
+
+bool crucio::orderWords(vector<string>* const words,
+                        vector<uint32_t>* const scores)
+{
+    scores->resize(words->size(), DEFAULT_SCORE);
+
+    // plain word list, alphabetic order
+    if (adjacent_find(scores->begin(), scores->end(),
+                      not_equal_to<uint32_t>()) == scores->end()) {
+
+        // strictly increasing means both sorted and unique
+        vector<string>::const_iterator wIt = words->begin();
+        if (wIt != words->end()) {
+            vector<string>::const_iterator prevIt = wIt;
+            for (++wIt; wIt != words->end(); prevIt = wIt, ++wIt) {
+                if (!(*prevIt < *wIt)) {
+                    break;
+                }
+            }
+        }
+        if (wIt == words->end()) {
+            return true;
+        }
+
+        sort(words->begin(), words->end());
+        words->erase(unique(words->begin(), words->end()), words->end());
+        scores->resize(words->size());
+        return false;
+    }
+
+    // duplicates are dropped alphabetically, then stable sorting by
+    // score leaves ties in alphabetic order
+    vector<uint32_t> order(words->size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), ByWord(*words, *scores));
+    order.erase(unique(order.begin(), order.end(), SameWord(*words)), order.end());
+    stable_sort(order.begin(), order.end(), ByScore(*scores));
+
+    vector<string> orderedWords(order.size());
+    vector<uint32_t> orderedScores(order.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        orderedWords[i].swap((*words)[order[i]]);
+        orderedScores[i] = (*scores)[order[i]];
+    }
+    words->swap(orderedWords);
+    scores->swap(orderedScores);
+    return false;
+}
+
 /* WordSet */
 
 #ifdef CRUCIO_C_ARRAYS
 
-WordSet::WordSet(const Alphabet alphabet, const uint32_t len) :
-    m_alphabet(alphabet),
-    m_alphabetSize(alphabetSize(m_alphabet)),
+// word ids alphabetically
+class ByPointer
+{
+public:
+    explicit ByPointer(const char** const pointers) :
+        m_pointers(pointers) {
+    }
+
+    bool operator()(const uint32_t id1, const uint32_t id2) const {
+        return (strcmp(m_pointers[id1], m_pointers[id2]) < 0);
+    }
+
+private:
+    const char** const m_pointers;
+};
+
+WordSet::WordSet(const SymbolTable* const symbols, const uint32_t len) :
+    m_symbols(symbols),
+    m_alphabetSize(m_symbols->getSize()),
     m_length(len),
     m_size(0),
     m_words(NULL),
     m_pointers(NULL),
+    m_scores(NULL),
+    m_uniformScore(DEFAULT_SCORE),
+    m_lookup(NULL),
+    m_columns(NULL),
     m_cpBuckets(m_length * m_alphabetSize),
     m_cpMatrix(NULL)
 {
@@ -29,6 +183,9 @@ WordSet::~WordSet()
     if (m_words) {
         free(m_words);
         free(m_pointers);
+        free(m_scores);
+        free(m_lookup);
+        free(m_columns);
         for (uint32_t i = 0; i < m_cpBuckets; ++i) {
             free(m_cpMatrix[i]);
         }
@@ -36,11 +193,14 @@ WordSet::~WordSet()
     }
 }
 
-void WordSet::load(const vector<string>& words)
+void WordSet::load(const vector<string>& words, const vector<uint32_t>& scores)
 {
     if (m_words) {
         free(m_words);
         free(m_pointers);
+        free(m_scores);
+        free(m_lookup);
+        free(m_columns);
         for (uint32_t i = 0; i < m_cpBuckets; ++i) {
             free(m_cpMatrix[i]);
         }
@@ -48,6 +208,9 @@ void WordSet::load(const vector<string>& words)
         m_size = 0;
         m_words = NULL;
         m_pointers = NULL;
+        m_scores = NULL;
+        m_lookup = NULL;
+        m_columns = NULL;
         m_cpMatrix = NULL;
     }
 
@@ -84,6 +247,10 @@ void WordSet::load(const vector<string>& words)
     // word id -> char pointer in bitmap
     m_pointers = (const char**) calloc(words.size(), sizeof(const char*));
 
+    // (position, word id) -> letter index
+    const size_t wordsCount = words.size();
+    m_columns = (unsigned char*) malloc(m_length * wordsCount + 1);
+
     // dynamic IDArray structs
     m_cpMatrix = (IDArray**) calloc(m_cpBuckets, sizeof(IDArray*));
     for (uint32_t i = 0; i < m_cpBuckets; ++i) {
@@ -118,6 +285,9 @@ void WordSet::load(const vector<string>& words)
             size_t& counter = cpCounters[bucket];
             m_cpMatrix[bucket]->ids[counter] = wordID;
             ++counter;
+
+            // letter index is the bucket offset within the position
+            m_columns[pos * wordsCount + wordID] = (unsigned char)(bucket - pos * m_alphabetSize);
         }
 
         // advance
@@ -127,6 +297,21 @@ void WordSet::load(const vector<string>& words)
 
     // save words count (= last wordId + 1)
     m_size = wordID;
+
+    // 4) scores, words are no longer alphabetic if they differ
+
+    m_uniformScore = (scores.empty() ? DEFAULT_SCORE : scores.front());
+    if (adjacent_find(scores.begin(), scores.end(),
+                      not_equal_to<uint32_t>()) != scores.end()) {
+        m_scores = (uint32_t*) malloc(wordsCount * sizeof(uint32_t));
+        copy(scores.begin(), scores.end(), m_scores);
+
+        m_lookup = (uint32_t*) malloc(wordsCount * sizeof(uint32_t));
+        for (uint32_t id = 0; id < m_size; ++id) {
+            m_lookup[id] = id;
+        }
+        sort(m_lookup, m_lookup + m_size, ByPointer(m_pointers));
+    }
 //    for (uint32_t i = 0; i < m_size; ++i) {
 //        cout << ">>> " << i << " = " << m_pointers[i] << endl;
 //    }
@@ -142,11 +327,40 @@ void WordSet::load(const vector<string>& words)
 //    }
 }
 
+uint32_t WordSet::getWordID(const string& word) const
+{
+    if (word.length() != m_length) {
+        return UINT_MAX;
+    }
+
+    // alphabetic position -> id
+    uint32_t first = 0;
+    uint32_t last = m_size;
+    while (first < last) {
+        const uint32_t middle = first + (last - first) / 2;
+        const uint32_t id = (m_lookup ? m_lookup[middle] : middle);
+        if (strcmp(m_pointers[id], word.c_str()) < 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    // found?
+    if (first < m_size) {
+        const uint32_t id = (m_lookup ? m_lookup[first] : first);
+        if (strcmp(m_pointers[id], word.c_str()) == 0) {
+            return id;
+        }
+    }
+    return UINT_MAX;
+}
+
 #else
 
-WordSet::WordSet(const Alphabet alphabet, const uint32_t len) :
-    m_alphabet(alphabet),
-    m_alphabetSize(alphabetSize(m_alphabet)),
+WordSet::WordSet(const SymbolTable* const symbols, const uint32_t len) :
+    m_symbols(symbols),
+    m_alphabetSize(m_symbols->getSize()),
     m_length(len),
     m_words(),
     m_cpMatrix(len * m_alphabetSize)
@@ -184,16 +398,10 @@ void WordSet::insert(const string& word)
 
 /* WordSetIndex */
 
-WordSetIndex::WordSetIndex(const Alphabet alphabet, const uint32_t minLength, const uint32_t maxLength) :
-    m_alphabet(alphabet),
-    m_minLength(minLength),
-    m_maxLength(maxLength),
-    m_wordSets(maxLength - minLength + 1)
+WordSetIndex::WordSetIndex(const SymbolTable& symbols) :
+    m_symbols(symbols),
+    m_wordSets()
 {
-    const uint32_t wsSize = (uint32_t)m_wordSets.size();
-    for (uint32_t wsi = 0; wsi < wsSize; ++wsi) {
-        m_wordSets[wsi] = new WordSet(m_alphabet, getReverseHash(wsi));
-    }
 }
 
 WordSetIndex::~WordSetIndex()
@@ -212,7 +420,22 @@ uint32_t WordSetIndex::getSize() const
     for (wsIt = m_wordSets.begin(); wsIt !=
             m_wordSets.end(); ++wsIt) {
         const WordSet* const ws = *wsIt;
-        totalSize += ws->getSize();
+        if (ws) {
+            totalSize += ws->getSize();
+        }
     }
     return totalSize;
 }
+
+WordSet* WordSetIndex::createWordSet(const uint32_t len)
+{
+    if (len >= m_wordSets.size()) {
+        m_wordSets.resize(len + 1, NULL);
+    }
+
+    WordSet*& ws = m_wordSets[len];
+    if (!ws) {
+        ws = new WordSet(&m_symbols, len);
+    }
+    return ws;
+}
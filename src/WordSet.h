@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "common.h"
+#include "SymbolTable.h"
 
 namespace crucio
 {
@@ -27,16 +28,33 @@ namespace crucio
 
     /* utils */
 
+    // score of words listed without one ("WORD;SCORE" lines), middle of
+    // the usual 0-100 range
+    const uint32_t DEFAULT_SCORE = 50;
+
+    // score field in [first, last), decimal digits with trailing blanks
+    // allowed (e.g. '\r'); false if malformed or past UINT_MAX
+    bool parseScore(const char* first, const char* last,
+                    uint32_t* const score);
+
+    // puts words in load order, by descending score and alphabetically,
+    // dropping duplicates (best score kept); true if they already were,
+    // as checked in a single pass when scores are all equal
+    bool orderWords(std::vector<std::string>* const words,
+                    std::vector<uint32_t>* const scores);
+
 #ifdef CRUCIO_C_ARRAYS
 // wordset of fixed length
     class WordSet
     {
     public:
-        WordSet(const Alphabet alphabet, const uint32_t len);
+        WordSet(const SymbolTable* const symbols, const uint32_t len);
         ~WordSet();
 
-        // load a words array (must be uppercase)
-        void load(const std::vector<std::string>& words);
+        // load a words array (must be normalized to symbols) in ID
+        // order, scores in parallel (none = DEFAULT_SCORE)
+        void load(const std::vector<std::string>& words,
+                  const std::vector<uint32_t>& scores = std::vector<uint32_t>());
 
 //        bool contains(const std::string& word) const {
 //            return std::binary_search(m_words.begin(),
@@ -55,47 +73,46 @@ namespace crucio
             return m_pointers[id];
         }
 
-//        // finds word offset within wordset
-//        const uint32_t getWordID(const string& word) const {
-//            const vector<string>::const_iterator wIt =
-//            lower_bound(m_words.begin(),
-//                        m_words.end(),
-//                        word);
-//
-//            // found?
-//            if (word >= *wIt) {
-//                return distance(m_words.begin(), wIt);
-//            } else {
-//
-//                // same as distance(m_words.begin(), m_words.end())
-//                return m_words.size();
-//            }
-//        }
+        // finds word offset within wordset (binary search on words
+        // order), UINT_MAX if missing
+        uint32_t getWordID(const std::string& word) const;
+
+        // word quality, IDs ascend as scores descend
+        uint32_t getScore(const uint32_t id) const {
+            return (m_scores ? m_scores[id] : m_uniformScore);
+        }
+
+        // false if all words share a score, IDs are then alphabetic
+        bool isScored() const {
+            return (m_scores != NULL);
+        }
 
         // vector of words (offsets) containing ch at position pos
         const IDArray* getCPVector(const uint32_t pos, const char ch) const {
             return m_cpMatrix[getHash(pos, ch)];
         }
 
+        // letter indexes at position pos, addressed by word ID
+        const unsigned char* getColumn(const uint32_t pos) const {
+            return m_columns + pos * m_size;
+        }
+
         // possible letters at position pos
         void getPossibleAt(const uint32_t pos, ABMask* const possible) const {
 
-            // initially empty letter mask
-            possible->reset();
-
             // adds all characters that appear at position pos
-            const uint32_t cpStart = getHash(pos, m_alphabet);
+            const uint32_t cpStart = pos * m_alphabetSize;
+            ABMask::Bits bits = 0;
             for (uint32_t i = 0; i < m_alphabetSize; ++i) {
-                if (m_cpMatrix[cpStart + i]->length > 0) {
-                    possible->set(i);
-                }
+                bits |= ((ABMask::Bits) (m_cpMatrix[cpStart + i]->length > 0)) << i;
             }
+            *possible = ABMask(bits);
         }
 
     private:
 
         // fixed alphabet and word length
-        const Alphabet m_alphabet;
+        const SymbolTable* const m_symbols;
         const uint32_t m_alphabetSize;
         const uint32_t m_length;
 
@@ -106,13 +123,24 @@ namespace crucio
         // word id -> location in m_words
         const char** m_pointers;
 
+        // word id -> score, NULL if all equal to m_uniformScore
+        uint32_t* m_scores;
+        uint32_t m_uniformScore;
+
+        // word ids in alphabetic order, NULL if same as ids
+        uint32_t* m_lookup;
+
+        // column-major copy of m_words as letter indexes, one m_size
+        // long column per position
+        unsigned char* m_columns;
+
         // the (<position, letter> -> array of word offsets) table
         const uint32_t m_cpBuckets;
         IDArray** m_cpMatrix;
 
         // hash function for m_cpMatrix buckets addressing
         uint32_t getHash(const uint32_t pos, const char ch) const {
-            return (pos * m_alphabetSize + character2Index(m_alphabet, ch));
+            return (pos * m_alphabetSize + m_symbols->getIndex(ch));
         }
     };
 #else
@@ -120,10 +148,10 @@ namespace crucio
     class WordSet
     {
     public:
-        WordSet(const Alphabet alphabet, const uint32_t len);
+        WordSet(const SymbolTable* const symbols, const uint32_t len);
         ~WordSet();
 
-        // inserts a word (must be uppercase)
+        // inserts a word (must be normalized to symbols)
         void insert(const std::string& word);
 
 //        bool contains(const std::string& word) const {
@@ -139,22 +167,26 @@ namespace crucio
             return m_words[id];
         }
 
-//        // finds word offset within wordset
-//        const uint32_t getWordID(const std::string& word) const {
-//            const std::vector<std::string>::const_iterator wIt =
-//                    std::lower_bound(m_words.begin(),
-//                                     m_words.end(),
-//                                     word);
-//
-//            // found?
-//            if (word >= *wIt) {
-//                return std::distance(m_words.begin(), wIt);
-//            } else {
-//
-//                // same as distance(m_words.begin(), m_words.end())
-//                return m_words.size();
-//            }
-//        }
+        // scores unsupported, words are inserted alphabetically
+        uint32_t getScore(const uint32_t id) const {
+            return DEFAULT_SCORE;
+        }
+        bool isScored() const {
+            return false;
+        }
+
+        // finds word offset within wordset (binary search, words are
+        // inserted sorted), UINT_MAX if missing
+        uint32_t getWordID(const std::string& word) const {
+            const std::vector<std::string>::const_iterator wIt =
+                std::lower_bound(m_words.begin(), m_words.end(), word);
+
+            // found?
+            if ((wIt != m_words.end()) && (*wIt == word)) {
+                return (uint32_t)std::distance(m_words.begin(), wIt);
+            }
+            return UINT_MAX;
+        }
 
         // vector of words (offsets) containing ch at position pos
         const std::vector<uint32_t>* getCPVector(const uint32_t pos,
@@ -170,7 +202,7 @@ namespace crucio
             possible->reset();
 
             // adds all characters that appear at position pos
-            const uint32_t cpStart = getHash(pos, m_alphabet);
+            const uint32_t cpStart = pos * m_alphabetSize;
             for (uint32_t i = 0; i < m_alphabetSize; ++i) {
                 if (!m_cpMatrix[cpStart + i].empty()) {
                     possible->set(i);
@@ -181,7 +213,7 @@ namespace crucio
     private:
 
         // fixed alphabet and word length, words vector
-        const Alphabet m_alphabet;
+        const SymbolTable* const m_symbols;
         const uint32_t m_alphabetSize;
         const uint32_t m_length;
         std::vector<std::string> m_words;
@@ -191,51 +223,49 @@ namespace crucio
 
         // hash function for m_cpMatrix buckets addressing
         uint32_t getHash(const uint32_t pos, const char ch) const {
-            return (pos * m_alphabetSize + reverseAlphabet(ch));
+            return (pos * m_alphabetSize + m_symbols->getIndex(ch));
         }
     };
 #endif
 
-// encloses a set of wordsets whose word length parameter falls
-// within [m_minLength, m_maxLength]
+// encloses the wordsets of the word lengths actually found in a
+// dictionary, created on demand and addressed by length
     class WordSetIndex
     {
     public:
-        WordSetIndex(const Alphabet alphabet, const uint32_t minLength, const uint32_t maxLength);
+        WordSetIndex(const SymbolTable& symbols);
         ~WordSetIndex();
 
-        const Alphabet getAlphabet() const {
-            return m_alphabet;
+        const SymbolTable& getSymbols() const {
+            return m_symbols;
         }
 
         // computes size as wordsets sizes sum
         uint32_t getSize() const;
 
+        // NULL if no words have length len
         const WordSet* getWordSet(const uint32_t len) const {
-            return m_wordSets[getHash(len)];
+            return ((len < m_wordSets.size()) ? m_wordSets[len] : NULL);
         }
         WordSet* getWordSet(const uint32_t len) {
-            return m_wordSets[getHash(len)];
+            return ((len < m_wordSets.size()) ? m_wordSets[len] : NULL);
+        }
+
+        // returns wordset for length len, creating it if missing
+        WordSet* createWordSet(const uint32_t len);
+
+        // every wordset length is below this
+        uint32_t getLengthBound() const {
+            return (uint32_t)m_wordSets.size();
         }
 
     private:
 
-        // min and max length for a word
-        const Alphabet m_alphabet;
-        const uint32_t m_minLength;
-        const uint32_t m_maxLength;
+        // alphabet shared by wordsets
+        const SymbolTable m_symbols;
 
-        // wordsets vector
+        // (word length -> wordset) table, NULL for missing lengths
         std::vector<WordSet*> m_wordSets;
-
-        // hash functions to map (word length -> wordset)
-        // and (wordset index -> word length)
-        uint32_t getHash(const uint32_t len) const {
-            return (len - m_minLength);
-        }
-        uint32_t getReverseHash(const uint32_t i) const {
-            return (i + m_minLength);
-        }
     };
 }
 
@@ -16,7 +16,6 @@
 
 #include <cassert>
 #include <iostream>
-#include <bitset>
 
 namespace crucio
 {
@@ -59,7 +58,146 @@ namespace crucio
         }
     }
 
-    /* global alphabet management (IMPORTANT: only uppercase letters!) */
+    /* bitmask primitives (plain integer masks) */
+
+    // number of set bits
+    inline uint32_t bitCount(const uint32_t bits)
+    {
+#ifdef __GNUC__
+        return (uint32_t)__builtin_popcount(bits);
+#else
+        uint32_t v = bits - ((bits >> 1) & 0x55555555);
+        v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+        return ((((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24);
+#endif
+    }
+
+    // index of lowest set bit (bits MUST be non-zero)
+    inline uint32_t firstBit(const uint32_t bits)
+    {
+        assert(bits != 0);
+#ifdef __GNUC__
+        return (uint32_t)__builtin_ctz(bits);
+#else
+        uint32_t i = 0;
+        while (!(bits & (1U << i))) {
+            ++i;
+        }
+        return i;
+#endif
+    }
+
+    // index of the r-th lowest set bit (r MUST be < bitCount(bits))
+    inline uint32_t selectBit(uint32_t bits, uint32_t r)
+    {
+        assert(r < bitCount(bits));
+
+#if defined(__GNUC__) && defined(__BMI2__)
+        // deposits the r-th bit onto the mask
+        return firstBit(__builtin_ia32_pdep_si(1U << r, bits));
+#else
+        // skips whole bytes by population count
+        uint32_t shift = 0;
+        uint32_t byteCount = bitCount(bits & 0xFF);
+        while (r >= byteCount) {
+            r -= byteCount;
+            bits >>= 8;
+            shift += 8;
+            byteCount = bitCount(bits & 0xFF);
+        }
+
+        // drops the r lowest bits within the byte
+        while (r > 0) {
+            bits &= bits - 1;
+            --r;
+        }
+        return shift + firstBit(bits);
+#endif
+    }
+
+    // 64-bit variants
+    inline uint32_t bitCount(const uint64_t bits)
+    {
+        return bitCount((uint32_t)bits) + bitCount((uint32_t)(bits >> 32));
+    }
+    inline uint32_t firstBit(const uint64_t bits)
+    {
+        assert(bits != 0);
+        const uint32_t low = (uint32_t)bits;
+        return (low ? firstBit(low) : 32 + firstBit((uint32_t)(bits >> 32)));
+    }
+    inline uint32_t selectBit(const uint64_t bits, const uint32_t r)
+    {
+        const uint32_t low = (uint32_t)bits;
+        const uint32_t lowCount = bitCount(low);
+        if (r < lowCount) {
+            return selectBit(low, r);
+        }
+        return 32 + selectBit((uint32_t)(bits >> 32), r - lowCount);
+    }
+
+    // lightweight pseudorandom generator (xorshift), one per context
+    class Random
+    {
+    public:
+        Random(const uint32_t seed = 1) {
+            setSeed(seed);
+        }
+
+        // 0 is a fixed point for xorshift, remaps it
+        void setSeed(const uint32_t seed) {
+            m_state = (seed ? seed : 0x9E3779B9);
+        }
+
+        uint32_t next() {
+            m_state ^= m_state << 13;
+            m_state ^= m_state >> 17;
+            m_state ^= m_state << 5;
+            return m_state;
+        }
+
+        // in [0, bound), modulo biased unless bound divides 2^32
+        uint32_t next(const uint32_t bound) {
+            return next() % bound;
+        }
+
+    private:
+        uint32_t m_state;
+    };
+
+    // index of a randomly chosen set bit (bits MUST be non-zero), same
+    // modulo bias as Random::next(bound)
+    template<typename Bits>
+    inline uint32_t randomBit(const Bits bits, const uint32_t random)
+    {
+        return selectBit(bits, random % bitCount(bits));
+    }
+    template<typename Bits>
+    inline uint32_t randomBit(const Bits bits, Random* const random)
+    {
+        return selectBit(bits, random->next(bitCount(bits)));
+    }
+
+    // reference counts shared across threads, atomic when built with
+    // CRUCIO_THREADS; both return the updated count
+    inline uint32_t incrementRefs(volatile uint32_t* const refs)
+    {
+#ifdef CRUCIO_THREADS
+        return __sync_add_and_fetch(refs, 1);
+#else
+        return ++*refs;
+#endif
+    }
+    inline uint32_t decrementRefs(volatile uint32_t* const refs)
+    {
+#ifdef CRUCIO_THREADS
+        return __sync_sub_and_fetch(refs, 1);
+#else
+        return --*refs;
+#endif
+    }
+
+    /* built-in alphabets (see SymbolTable for custom ones) */
 
     // alphabet kind (base character)
     enum Alphabet {
@@ -70,11 +208,132 @@ namespace crucio
     // alphabet/domain size
     enum AlphabetSize {
         LETTERS_COUNT = 26,
-        DIGITS_COUNT = 10
+        DIGITS_COUNT = 10,
+        MAX_ALPHABET_COUNT = 64
+    };
+
+    // native integer holding SIZE bits
+    template<uint32_t SIZE, bool WIDE = (SIZE > 32)>
+    struct ABMaskBits {
+        typedef uint32_t Type;
+    };
+    template<uint32_t SIZE>
+    struct ABMaskBits<SIZE, true> {
+        typedef uint64_t Type;
+    };
+
+    // domain mask for an alphabet of (at most) SIZE symbols
+    template<uint32_t SIZE>
+    class BasicABMask
+    {
+    public:
+        typedef typename ABMaskBits<SIZE>::Type Bits;
+
+        // all SIZE bits set
+        static const Bits FULL = (((((Bits) 1) << (SIZE - 1)) << 1) - 1);
+
+        BasicABMask() :
+            m_bits(0) {
+        }
+        explicit BasicABMask(const Bits bits) :
+            m_bits(bits) {
+        }
+
+        // first size bits set
+        static BasicABMask full(const uint32_t size) {
+            assert(size <= SIZE);
+            return BasicABMask((((((Bits) 1) << (size - 1)) << 1) - 1));
+        }
+
+        // plain integer view
+        Bits bits() const {
+            return m_bits;
+        }
+
+        // single bits
+        bool test(const uint32_t i) const {
+            return ((m_bits >> i) & 1);
+        }
+        bool operator[](const uint32_t i) const {
+            return test(i);
+        }
+        void set(const uint32_t i) {
+            m_bits |= (((Bits) 1) << i);
+        }
+        void reset(const uint32_t i) {
+            m_bits &= ~(((Bits) 1) << i);
+        }
+        void reset() {
+            m_bits = 0;
+        }
+
+        // whole mask
+        bool any() const {
+            return (m_bits != 0);
+        }
+        bool none() const {
+            return (m_bits == 0);
+        }
+        uint32_t count() const {
+            return bitCount(m_bits);
+        }
+
+        // iteration over set bits (mask MUST be non-empty)
+        uint32_t first() const {
+            return firstBit(m_bits);
+        }
+        uint32_t select(const uint32_t r) const {
+            return selectBit(m_bits, r);
+        }
+
+        // set operations
+        BasicABMask& operator&=(const BasicABMask& mask) {
+            m_bits &= mask.m_bits;
+            return *this;
+        }
+        BasicABMask& operator|=(const BasicABMask& mask) {
+            m_bits |= mask.m_bits;
+            return *this;
+        }
+        BasicABMask operator&(const BasicABMask& mask) const {
+            return BasicABMask(m_bits & mask.m_bits);
+        }
+        BasicABMask operator|(const BasicABMask& mask) const {
+            return BasicABMask(m_bits | mask.m_bits);
+        }
+        BasicABMask operator~() const {
+            return BasicABMask(~m_bits & FULL);
+        }
+        bool operator==(const BasicABMask& mask) const {
+            return (m_bits == mask.m_bits);
+        }
+        bool operator!=(const BasicABMask& mask) const {
+            return (m_bits != mask.m_bits);
+        }
+
+    private:
+        Bits m_bits;
+    };
+
+    template<uint32_t SIZE>
+    const typename BasicABMask<SIZE>::Bits BasicABMask<SIZE>::FULL;
+
+    // per alphabet sizes
+    template<Alphabet A>
+    struct AlphabetTraits;
+
+    template<>
+    struct AlphabetTraits<LETTERS> {
+        static const uint32_t SIZE = LETTERS_COUNT;
+    };
+
+    template<>
+    struct AlphabetTraits<DIGITS> {
+        static const uint32_t SIZE = DIGITS_COUNT;
     };
 
     // domain mask to hold max alphabet size
-    typedef std::bitset<LETTERS_COUNT> ABMask; // max(letters, digits)
+    typedef BasicABMask<MAX_ALPHABET_COUNT> ABMask;
 
     // wildcard (any characater)
     const char ANY_CHAR = '-';
@@ -84,10 +343,10 @@ namespace crucio
     {
         switch (alphabet) {
         case LETTERS:
-            return LETTERS_COUNT;
+            return AlphabetTraits<LETTERS>::SIZE;
 
         case DIGITS:
-            return DIGITS_COUNT;
+            return AlphabetTraits<DIGITS>::SIZE;
         }
 
         // should never happen
@@ -95,39 +354,6 @@ namespace crucio
         return 0;
     }
 
-    // totally active mask
-    inline ABMask anyMask(const Alphabet alphabet)
-    {
-        ABMask mask;
-        const uint32_t size = alphabetSize(alphabet);
-        for (size_t i = 0; i < size; ++i) {
-            mask.set(i);
-        }
-        return mask;
-    }
-    inline void setAnyMask(const Alphabet alphabet, ABMask* const mask)
-    {
-        const uint32_t size = alphabetSize(alphabet);
-        for (size_t i = 0; i < size; ++i) {
-            mask->set(i);
-        }
-    }
-
-    // maps i to i-th letter of alphabet
-    inline char index2Character(const Alphabet alphabet, const uint32_t i)
-    {
-        return (char)(alphabet + i);
-    }
-
-    // maps ch to its alphabet index
-    inline uint32_t character2Index(const Alphabet alphabet, const char ch)
-    {
-        return (ch - alphabet);
-    }
-
-    // ABMask string representation by alphabet
-    std::string ABMaskString(const Alphabet alphabet, const ABMask mask);
-
     /* exceptions */
 
     class CrucioException
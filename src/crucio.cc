@@ -9,6 +9,42 @@ using namespace crucio;
 using namespace std;
 using namespace TCLAP;
 
+// set on SIGINT, polled by compiler budget
+static volatile sig_atomic_t cancelled = 0;
+
+static void onInterrupt(int)
+{
+    cancelled = 1;
+}
+
+// per-run words over dictionary, a word each line (with optional
+// score as in dictionary)
+static void loadOverlay(Dictionary* const dict, const string& filename,
+                        const bool banned)
+{
+    ifstream wordsIn(filename.c_str());
+    if (!wordsIn.is_open()) {
+        throw DictionaryException("dictionary: unable to open overlay words list");
+    }
+
+    string line;
+    while (getline(wordsIn, line)) {
+        const size_t separator = line.find(';');
+        const string word = line.substr(0, separator);
+        uint32_t score = DEFAULT_SCORE;
+        if ((separator != string::npos) &&
+                !parseScore(line.data() + separator + 1,
+                            line.data() + line.size(), &score)) {
+            throw DictionaryException("dictionary: invalid word score in overlay words list");
+        }
+        if (banned) {
+            dict->banWord(word);
+        } else {
+            dict->addWord(word, score);
+        }
+    }
+}
+
 int main(int argc, char* argv[])
 {
 
@@ -17,6 +53,9 @@ int main(int argc, char* argv[])
 
     // heap objects
     Matcher* inMatcher = NULL;
+    Matcher* inViewMatcher = NULL;
+    WordFilter* inFilter = NULL;
+    Dictionary* inView = NULL;
     Compiler* inCpl = NULL;
     Walk* inWalk = NULL;
 
@@ -29,12 +68,15 @@ int main(int argc, char* argv[])
         vector<string> allowedFillStr;
         allowedFillStr.push_back("letter");
         allowedFillStr.push_back("word");
+        allowedFillStr.push_back("hybrid");
         ValuesConstraint<string> allowedFillVals(allowedFillStr);
 
         // sets constrained walk values
         vector<string> allowedWalkStr;
         allowedWalkStr.push_back("bfs");
         allowedWalkStr.push_back("dfs");
+        allowedWalkStr.push_back("rcm");
+        allowedWalkStr.push_back("width");
         ValuesConstraint<string> allowedWalkVals(allowedWalkStr);
 
         // sets default random seed to current time
@@ -49,6 +91,8 @@ int main(int argc, char* argv[])
                             "filling (required for fill-in puzzles)", false);
         SwitchArg verboseArg("v", "verbose", "Print out algorithmic steps",
                              false);
+        SwitchArg partialArg("P", "partial", "Output best partial fill " \
+                             "if compilation is interrupted", false);
 
         // labeled arguments
         ValueArg<string> dictArg("d", "dictionary", "Dictionary file",
@@ -59,8 +103,32 @@ int main(int argc, char* argv[])
                                  "letter", &allowedFillVals);
         ValueArg<string> walkArg("w", "walk", "Cell graph walk for variable " \
                                  "ordering", false, "bfs", &allowedWalkVals);
+        ValueArg<uint32_t> scoreArg("s", "score", "Minimum word score " \
+                                    "(dictionary lines as WORD;SCORE)", false,
+                                    0, "score");
+        ValueArg<string> extraArg("e", "extra", "Words list added over " \
+                                  "dictionary", false, "", "extra");
+        ValueArg<string> bannedArg("x", "banned", "Words list banned from " \
+                                   "dictionary", false, "", "banned");
+        ValueArg<string> alphabetArg("a", "alphabet", "Alphabet file " \
+                                     "(symbols and their folded variants)",
+                                     false, "", "alphabet");
         ValueArg<uint32_t> seedArg("r", "seed", "Random seed", false,
                                    nowTicks * nowTicks, "seed");
+        ValueArg<uint32_t> timeoutArg("t", "timeout", "Compilation deadline " \
+                                      "in milliseconds (0 = none)", false, 0, "millis");
+        ValueArg<uint32_t> nodesArg("n", "nodes", "Maximum values tried " \
+                                    "(0 = unlimited)", false, 0, "nodes");
+        ValueArg<uint32_t> backtracksArg("b", "backtracks", "Maximum " \
+                                         "backtracks (0 = unlimited)", false, 0, "backtracks");
+        ValueArg<uint32_t> solutionsArg("k", "solutions", "Enumerate up " \
+                                        "to k solutions (0 = all)", false, 1, "k");
+        ValueArg<uint32_t> distanceArg("m", "distance", "Minimum letters " \
+                                       "changed between enumerated solutions",
+                                       false, 0, "letters");
+        ValueArg<uint32_t> cacheArg("c", "cache", "Match cache size in " \
+                                    "megabytes (0 disables)", false,
+                                    MatchCache::DEFAULT_CAPACITY >> 20, "megabytes");
 
         // unlabeled arguments
         UnlabeledValueArg<string> fileArg("file", "Output file " \
@@ -72,11 +140,22 @@ int main(int argc, char* argv[])
         cmd.add(dictArg);
         cmd.add(fileArg);
         cmd.add(verboseArg);
+        cmd.add(partialArg);
         cmd.add(determArg);
         cmd.add(uniqueArg);
         cmd.add(seedArg);
         cmd.add(walkArg);
         cmd.add(fillArg);
+        cmd.add(alphabetArg);
+        cmd.add(scoreArg);
+        cmd.add(extraArg);
+        cmd.add(bannedArg);
+        cmd.add(cacheArg);
+        cmd.add(timeoutArg);
+        cmd.add(nodesArg);
+        cmd.add(backtracksArg);
+        cmd.add(solutionsArg);
+        cmd.add(distanceArg);
 
         // command line parsing
         cmd.parse(argc, argv);
@@ -84,23 +163,59 @@ int main(int argc, char* argv[])
         // verbosity
         setVerbose(verboseArg.getValue());
 
+        // cache capacity in bytes, must fit MatchCache counters
+        const uint64_t cacheMB = cacheArg.getValue();
+        if (cacheMB > (UINT_MAX >> 20)) {
+            throw CrucioException("main: cache size too large");
+        }
+        const uint32_t cacheBytes = (uint32_t)(cacheMB << 20);
+
         // allocates data structures through input arguments
         const Alphabet inAlphabet = crucio::LETTERS;
         const Grid inGrid(gridArg.getValue());
 
         // chooses matcher
         switch (inAlphabet) {
-        case LETTERS:
-            inMatcher = new LanguageMatcher(dictArg.getValue());
-            break;
+        case LETTERS: {
+                LanguageMatcher* const langMatcher =
+                    new LanguageMatcher(dictArg.getValue());
+                langMatcher->getCache().setCapacity(cacheBytes);
+                inMatcher = langMatcher;
+                break;
+            }
 
         case DIGITS:
             inMatcher = new SolutionMatcher();
             break;
         }
 
+        // alphabet symbols, built-in unless a file is given
+        const SymbolTable inSymbols = (alphabetArg.isSet() ?
+                                       SymbolTable(alphabetArg.getValue()) :
+                                       SymbolTable(inAlphabet));
+
         // creates dictionary with matcher
-        Dictionary inDict(inAlphabet, inMatcher);
+        Dictionary inDict(inSymbols, inMatcher);
+
+        // low scoring words left out through a view
+        Dictionary* dict = &inDict;
+        if (scoreArg.isSet()) {
+            inFilter = new WordFilter(inDict.getIndex());
+            inFilter->allowAll(scoreArg.getValue());
+
+            LanguageMatcher* const viewMatcher = new LanguageMatcher();
+            viewMatcher->getCache().setCapacity(cacheBytes);
+            inViewMatcher = viewMatcher;
+            inView = new Dictionary(&inDict, inViewMatcher, inFilter);
+            dict = inView;
+        }
+
+        if (extraArg.isSet()) {
+            loadOverlay(dict, extraArg.getValue(), false);
+        }
+        if (bannedArg.isSet()) {
+            loadOverlay(dict, bannedArg.getValue(), true);
+        }
 
 #ifndef USE_BENCHMARK
         // binary output
@@ -111,13 +226,13 @@ int main(int argc, char* argv[])
 #endif
 
         // prints out input description
-        printInputDescription(cout, inDict, inGrid,
+        printInputDescription(cout, *dict, inGrid,
                               fillArg.getValue(), walkArg.getValue(),
                               uniqueArg.getValue(), determArg.getValue(),
                               seedArg.getValue(), verboseArg.getValue());
 
         // model building
-        Model inModel(&inDict, &inGrid);
+        Model inModel(dict, &inGrid);
 
         // if verbose prints out model description too
         if (verboseArg.getValue()) {
@@ -130,34 +245,64 @@ int main(int argc, char* argv[])
             inCpl = new LetterCompiler();
         } else if (fillArg.getValue() == "word") {
             inCpl = new WordCompiler();
+        } else if (fillArg.getValue() == "hybrid") {
+            inCpl = new HybridCompiler();
         }
         inCpl->setUnique(uniqueArg.getValue());
         inCpl->setDeterministic(determArg.getValue());
-        inCpl->setTimeoutSeconds(0);
+
+        // search limits, SIGINT cancels gracefully
+        Budget& budget = inCpl->getBudget();
+        budget.setDeadlineMillis(timeoutArg.getValue());
+        budget.setNodeLimit(nodesArg.getValue());
+        budget.setBacktrackLimit(backtracksArg.getValue());
+        budget.setCancelFlag(&cancelled);
+        signal(SIGINT, onInterrupt);
+        inCpl->setSeed(seedArg.getValue());
+
+        // solutions enumeration, streamed to output as found
+#ifndef USE_BENCHMARK
+        OutputSink outSink(&cout, &outFile);
+#else
+        OutputSink outSink(&cout, NULL);
+#endif
+        const bool enumerate = (solutionsArg.isSet() || distanceArg.isSet());
+        if (enumerate) {
+            inCpl->setSolutionSink(&outSink);
+            inCpl->setSolutionLimit(solutionsArg.getValue());
+            inCpl->setMinDistance(distanceArg.getValue());
+        }
 
         // walk selection
         if (walkArg.getValue() == "bfs") {
             inWalk = new BFSWalk();
         } else if (walkArg.getValue() == "dfs") {
             inWalk = new DFSWalk();
+        } else if (walkArg.getValue() == "rcm") {
+            inWalk = new RCMWalk();
+        } else if (walkArg.getValue() == "width") {
+            inWalk = new MinWidthWalk();
         } else {
             // assert(false)
         }
 
-        // pseudorandom generator initialization
-        srand(seedArg.getValue());
-
         if (verboseArg.getValue()) {
             cout << "[ALGORITHM]" << endl << endl;
         }
 
         // execution
-        switch (inCpl->compile(&inModel, *inWalk)) {
+        const Compiler::Result result = inCpl->compile(&inModel, *inWalk);
+        switch (result) {
         case Compiler::SUCCESS: {
 
                 // success!
                 status = 0;
 
+                // already streamed
+                if (enumerate) {
+                    break;
+                }
+
                 // prints out results
                 cout << "[OUTPUT]" << endl << endl;
                 //printModelGrid(cout, inModel);
@@ -188,6 +333,51 @@ int main(int argc, char* argv[])
                 cout << "failure: compilation timed out" << endl;
                 break;
             }
+        case Compiler::FAILURE_BUDGET: {
+                cout << "failure: search budget exhausted" << endl;
+                break;
+            }
+        case Compiler::FAILURE_CANCELLED: {
+                cout << "failure: compilation cancelled" << endl;
+                break;
+            }
+        }
+
+        // enumerated solutions, interrupted or not
+        if (enumerate) {
+            cout << "solutions = " << inCpl->getSolutionsNum() << endl;
+        }
+
+        // anytime mode, deepest fill reached before interruption
+        if (partialArg.getValue() && inCpl->isPartial()) {
+
+            // partial success
+            status = 1;
+
+            cout << endl << "[PARTIAL OUTPUT]" << endl << endl;
+            printOutput(cout, inModel);
+
+#ifndef USE_BENCHMARK
+            // flagged as partial in output file
+            const Output outData(inModel, true);
+            outData.printRaw(outFile);
+            outFile.close();
+#endif
+        }
+
+        // search effort
+        if (verboseArg.getValue()) {
+            cout << endl << "[SEARCH]" << endl << endl;
+            cout << "nodes = " << budget.getNodes() << ", backtracks = " <<
+                 budget.getBacktracks() << ", elapsed = " <<
+                 budget.getElapsedMillis() << " ms" << endl;
+        }
+
+        // matchings reuse
+        if (verboseArg.getValue() && (inAlphabet == LETTERS)) {
+            cout << endl << "[MATCH CACHE]" << endl << endl;
+            printMatchCacheStatistics(cout,
+                                      ((LanguageMatcher*) (inView ? inViewMatcher : inMatcher))->getCache());
         }
 
 #ifndef USE_BENCHMARK
@@ -204,6 +394,15 @@ int main(int argc, char* argv[])
     if (inCpl) {
         delete inCpl;
     }
+    if (inView) {
+        delete inView;
+    }
+    if (inFilter) {
+        delete inFilter;
+    }
+    if (inViewMatcher) {
+        delete inViewMatcher;
+    }
     if (inMatcher) {
         delete inMatcher;
     }
@@ -15,6 +15,7 @@
 #include "LanguageMatcher.h"
 #include "SolutionMatcher.h"
 #include "Grid.h"
+#include "HybridCompiler.h"
 #include "LetterCompiler.h"
 #include "Model.h"
 #include "Output.h"